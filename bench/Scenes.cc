@@ -0,0 +1,136 @@
+#include "Scenes.h"
+#include "ShaderCache.h"
+#include "Rectangle.h"
+#include "Circle.h"
+#include "SDFCircle.h"
+#include "Polygon.h"
+
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+/* Shader pairs & textures used by the scenes, relative to the repo root */
+#define SCENE_VERT "./shaders/shader.vert"
+#define SCENE_FRAG "./shaders/shader.frag"
+#define SCENE_FRAG_ALT "./shaders/shader2.frag"
+#define SCENE_FRAG_SDF "./shaders/sdf_circle.frag"
+#define SCENE_TEXTURE "./textures/615-checkerboard.png"
+#define SCENE_TEXTURE_ALT "./textures/gradient.png"
+
+/* Builds a Polygon from a ring, timing its construction */
+static Shape* timed_polygon(const std::vector<glm::vec2> &ring, std::shared_ptr<Shader> shader, double *triangulateMs) {
+  const auto start = std::chrono::steady_clock::now();
+  Shape *shape = reinterpret_cast<Shape*>(new Polygon(ring, shader, nullptr));
+  if (triangulateMs)
+    *triangulateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  shape->set_origin(shape->get_center_vec());
+  return shape;
+}
+
+namespace Scenes {
+  std::vector<Shape*> rectangles(size_t count, glm::vec2 area, const char *texture, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x(0.f, area.x), y(0.f, area.y), size(4.f, 40.f);
+    std::shared_ptr<Shader> shader = ShaderCache::get().load(SCENE_VERT, SCENE_FRAG);
+
+    std::vector<Shape*> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      // Drawn in a fixed order, argument evaluation order differs across compilers.
+      const float px = x(rng), py = y(rng);
+      const float width = size(rng), height = size(rng);
+
+      Shape *shape = reinterpret_cast<Shape*>(new Rectangle(px, py, width, height, shader, texture));
+      shape->set_origin(shape->get_center_vec());
+      shapes.push_back(shape);
+    }
+    return shapes;
+  }
+
+  std::vector<Shape*> circles(size_t count, size_t quality, glm::vec2 area, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x(0.f, area.x), y(0.f, area.y), radius(4.f, 60.f);
+    std::shared_ptr<Shader> shader = ShaderCache::get().load(SCENE_VERT, SCENE_FRAG_ALT);
+
+    std::vector<Shape*> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      const float px = x(rng), py = y(rng);
+      const float r = radius(rng);
+
+      Shape *shape = reinterpret_cast<Shape*>(new Circle(px, py, r, shader, nullptr, quality));
+      shape->set_origin(shape->get_center_vec());
+      shapes.push_back(shape);
+    }
+    return shapes;
+  }
+
+  std::vector<Shape*> concave_polygon(size_t points, glm::vec2 area, double *triangulateMs) {
+    std::shared_ptr<Shader> shader = ShaderCache::get().load(SCENE_VERT, SCENE_FRAG_ALT);
+
+    const glm::vec2 center = area * 0.5f;
+    const float outer = std::min(area.x, area.y) * 0.48f;
+    std::vector<glm::vec2> ring(points);
+    for (size_t i = 0; i < points; i++) {
+      const float angle = glm::two_pi<float>() * i / points;
+      const float radius = (i % 2) ? outer * 0.6f : outer;
+      ring[i] = center + radius * glm::vec2(cosf(angle), sinf(angle));
+    }
+
+    return { timed_polygon(ring, shader, triangulateMs) };
+  }
+
+  std::vector<Shape*> noisy_polygon(size_t points, glm::vec2 area, uint32_t seed, double *triangulateMs) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> scale(0.7f, 1.f);
+    std::shared_ptr<Shader> shader = ShaderCache::get().load(SCENE_VERT, SCENE_FRAG_ALT);
+
+    const glm::vec2 center = area * 0.5f;
+    const float outer = std::min(area.x, area.y) * 0.48f;
+    std::vector<glm::vec2> ring(points);
+    for (size_t i = 0; i < points; i++) {
+      const float angle = glm::two_pi<float>() * i / points;
+      ring[i] = center + outer * scale(rng) * glm::vec2(cosf(angle), sinf(angle));
+    }
+
+    return { timed_polygon(ring, shader, triangulateMs) };
+  }
+
+  std::vector<Shape*> mixed(size_t count, glm::vec2 area, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x(0.f, area.x), y(0.f, area.y), size(4.f, 40.f);
+    std::uniform_int_distribution<int> kind(0, 5);
+
+    std::shared_ptr<Shader> shader = ShaderCache::get().load(SCENE_VERT, SCENE_FRAG);
+    std::shared_ptr<Shader> alt = ShaderCache::get().load(SCENE_VERT, SCENE_FRAG_ALT);
+    std::shared_ptr<Shader> sdf = ShaderCache::get().load(SCENE_VERT, SCENE_FRAG_SDF);
+
+    std::vector<Shape*> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      // Drawn in a fixed order, argument evaluation order differs across compilers.
+      const int k = kind(rng);
+      const float px = x(rng), py = y(rng);
+      const float width = size(rng), height = size(rng);
+
+      Shape *shape = nullptr;
+      switch (k) {
+        case 0: shape = reinterpret_cast<Shape*>(new Rectangle(px, py, width, height, shader, SCENE_TEXTURE)); break;
+        case 1: shape = reinterpret_cast<Shape*>(new Rectangle(px, py, width, height, alt, SCENE_TEXTURE_ALT)); break;
+        case 2: shape = reinterpret_cast<Shape*>(new Rectangle(px, py, width, height, alt, nullptr)); break;
+        case 3: shape = reinterpret_cast<Shape*>(new Circle(px, py, width, alt, nullptr, 64)); break;
+        case 4: shape = reinterpret_cast<Shape*>(new Circle(px, py, width, shader, SCENE_TEXTURE, 64)); break;
+        default: shape = reinterpret_cast<Shape*>(new SDFCircle(px, py, width, sdf, SCENE_TEXTURE_ALT)); break;
+      }
+
+      // Layers interleave the kinds, as in a scene sorted by depth.
+      shape->set_layer(i % 4);
+      shape->set_origin(shape->get_center_vec());
+      shapes.push_back(shape);
+    }
+    return shapes;
+  }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Shape.h"
+
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Deterministic scene generators for the benchmarks.
+ *  Shapes are placed in pixel coordinates within the given area, from a
+ *  fixed seed, so every run draws the exact same scene. Shaders are
+ *  shared through the ShaderCache like in the app.
+ */
+namespace Scenes {
+  /**
+   * Rectangles of random sizes, textured or solid.
+   *
+   * @param count Number of rectangles.
+   * @param area Size of the area to fill.
+   * @param texture Texture of the rectangles, nullptr for solid.
+   * @param seed Seed of the placement.
+   */
+  std::vector<Shape*> rectangles(size_t count, glm::vec2 area, const char *texture, uint32_t seed);
+
+  /**
+   * Tessellated circles of random radii.
+   *
+   * @param count Number of circles.
+   * @param quality Max number of points per circle.
+   * @param area Size of the area to fill.
+   * @param seed Seed of the placement.
+   */
+  std::vector<Shape*> circles(size_t count, size_t quality, glm::vec2 area, uint32_t seed);
+
+  /**
+   * A single concave polygon, a star with alternating inner & outer
+   * points, filling the area. Triangulated when constructed.
+   *
+   * @param points Number of points on its ring.
+   * @param area Size of the area to fill.
+   * @param triangulateMs Set to the time spent constructing the polygon, mostly its triangulation.
+   */
+  std::vector<Shape*> concave_polygon(size_t points, glm::vec2 area, double *triangulateMs = nullptr);
+
+  /**
+   * A single polygon with a noisy outline, points at random radii between
+   * 70% & 100% of the area's, like a traced or scanned shape.
+   *
+   * @param points Number of points on its ring.
+   * @param area Size of the area to fill.
+   * @param seed Seed of the radii.
+   * @param triangulateMs Set to the time spent constructing the polygon, mostly its triangulation.
+   */
+  std::vector<Shape*> noisy_polygon(size_t points, glm::vec2 area, uint32_t seed, double *triangulateMs = nullptr);
+
+  /**
+   * Rectangles, circles & SDF circles spread over three shaders & two
+   * textures, breaking batches the way a real scene does.
+   *
+   * @param count Number of shapes.
+   * @param area Size of the area to fill.
+   * @param seed Seed of the placement.
+   */
+  std::vector<Shape*> mixed(size_t count, glm::vec2 area, uint32_t seed);
+};
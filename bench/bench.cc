@@ -0,0 +1,293 @@
+/*
+ * Rendering benchmarks.
+ *  Renders generated scenes headless for a fixed number of frames and
+ *  reports the frame time distribution, draw calls, bytes uploaded &
+ *  memory use as JSON, to catch regressions in Shape, BufferData & the
+ *  draw loop.
+ *
+ * Usage: bench [--frames N] [--out results.json] [--list] [scenarios...]
+ *  - Runs every scenario when none are named
+ *  - Each scenario runs in its own process, on a fresh GL Context
+ *  - Statistics cover the last FRAME_STATS_WINDOW frames, earlier frames
+ *  are warm-up
+ *  - Scenarios whose textures fail to load fail, instead of measuring
+ *  the placeholder texel
+ *  - setup_ms times building the scene, triangulate_ms the part of it
+ *  spent constructing polygons, 0 for scenes without any
+ */
+#include "SimpleRender.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "Scenes.h"
+#include "TextureCache.h"
+
+#include <spdlog/spdlog.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/* Size of the offscreen render target */
+#define BENCH_WIDTH 1600
+#define BENCH_HEIGHT 900
+
+/* Frames rendered per scenario, unless given --frames */
+#define BENCH_FRAMES 600
+
+/* Seed of every generated scene */
+#define BENCH_SEED 1234
+
+
+/* Benchmarked scene & how it's animated */
+struct Scenario {
+  const char *name;
+  std::function<std::vector<Shape*>(glm::vec2 area, double *triangulateMs)> build;
+  bool animated;      // Shapes rotate every frame, re-uploading their geometry
+};
+
+static const std::vector<Scenario> SCENARIOS = {
+  { "rects_1k_static",        [](glm::vec2 a, double*) { return Scenes::rectangles(1000, a, nullptr, BENCH_SEED); },            false },
+  { "rects_10k_static",       [](glm::vec2 a, double*) { return Scenes::rectangles(10000, a, nullptr, BENCH_SEED); },           false },
+  { "rects_10k_animated",     [](glm::vec2 a, double*) { return Scenes::rectangles(10000, a, nullptr, BENCH_SEED); },           true  },
+  { "rects_10k_textured",     [](glm::vec2 a, double*) { return Scenes::rectangles(10000, a, "./textures/615-checkerboard.png", BENCH_SEED); }, false },
+  { "circles_1k_q32",         [](glm::vec2 a, double*) { return Scenes::circles(1000, 32, a, BENCH_SEED); },                    false },
+  { "circles_1k_q32_animated",[](glm::vec2 a, double*) { return Scenes::circles(1000, 32, a, BENCH_SEED); },                    true  },
+  { "circles_100_q2000",      [](glm::vec2 a, double*) { return Scenes::circles(100, 2000, a, BENCH_SEED); },                   false },
+  { "polygon_10k",            [](glm::vec2 a, double *t) { return Scenes::concave_polygon(10000, a, t); },                      false },
+  { "polygon_100k",           [](glm::vec2 a, double *t) { return Scenes::concave_polygon(100000, a, t); },                     false },
+  { "polygon_100k_animated",  [](glm::vec2 a, double *t) { return Scenes::concave_polygon(100000, a, t); },                     true  },
+  { "polygon_1m",             [](glm::vec2 a, double *t) { return Scenes::concave_polygon(1000000, a, t); },                    false },
+  { "noisy_polygon_100k",     [](glm::vec2 a, double *t) { return Scenes::noisy_polygon(100000, a, BENCH_SEED, t); },           false },
+  { "noisy_polygon_1m",       [](glm::vec2 a, double *t) { return Scenes::noisy_polygon(1000000, a, BENCH_SEED, t); },          false },
+  { "mixed_5k_static",        [](glm::vec2 a, double*) { return Scenes::mixed(5000, a, BENCH_SEED); },                          false },
+  { "mixed_5k_animated",      [](glm::vec2 a, double*) { return Scenes::mixed(5000, a, BENCH_SEED); },                          true  },
+};
+
+
+/* Returns the resident & peak resident memory in KB */
+static void readMemory(size_t &rss, size_t &peak) {
+  rss = peak = 0;
+
+  long pages = 0, resident = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm) {
+    if (fscanf(statm, "%ld %ld", &pages, &resident) == 2)
+      rss = resident * (sysconf(_SC_PAGESIZE) / 1024);
+    fclose(statm);
+  }
+
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    peak = usage.ru_maxrss;
+}
+
+
+/**
+ * Renders a Scenario headless, accumulating the per-frame counters over
+ *  the measured frames.
+ */
+class BenchApp : public SimpleRender {
+  private:
+    const Scenario &scenario;
+    std::vector<Shape*> shapes;
+    size_t frames, warmup, frame = 0;
+
+  public:
+    double setupMs = 0.0, triangulateMs = 0.0;
+    size_t drawCalls = 0, batches = 0, uploaded = 0, verticies = 0;
+
+  private:
+    glm::mat4 getViewTransform() override {
+      return glm::ortho(0.f, (float)BENCH_WIDTH, 0.f, (float)BENCH_HEIGHT, -1.f, 1.f);
+    }
+
+    void Preload() override {
+      const double start = getTime();
+      this->shapes = this->scenario.build(glm::vec2(BENCH_WIDTH, BENCH_HEIGHT), &this->triangulateMs);
+      this->setupMs = (getTime() - start) * 1e3;
+    }
+
+    void Draw() override {
+      // Wait for the last frame, so frame times include the GPU's work.
+      glFinish();
+
+      // Counters describe the last finished frame.
+      if (this->frame > this->warmup) {
+        const BatchStats &stats = this->batchRenderer.getStats();
+        this->drawCalls += stats.drawCalls;
+        this->batches += stats.batches;
+        this->verticies += stats.verticies;
+        this->uploaded += GLState::getStats().uploaded;
+      }
+      this->frame++;
+
+      for (Shape *shape : this->shapes) {
+        if (this->scenario.animated) shape->rotate(0.01f);
+        shape->update_lod(1.f);
+        shape->update();
+        this->submit(shape);
+      }
+    }
+
+    void fixedUpdate(double) override {}
+
+  public:
+    BenchApp(const Scenario &scenario, size_t frames) :
+      SimpleRender(BENCH_WIDTH, BENCH_HEIGHT, scenario.name),
+      scenario(scenario),
+      frames(frames),
+      warmup(frames > FRAME_STATS_WINDOW ? frames - FRAME_STATS_WINDOW : 0) {
+      this->setHeadless(frames);
+
+      // Only system level zones, GPU frame times come from their timer queries.
+      Profiler::get().setEnabled(true);
+    }
+
+    ~BenchApp() {
+      for (Shape *shape : this->shapes) delete shape;
+    }
+
+    /* Returns whether every texture of the scene loaded, textures are all uploaded once run */
+    bool texturesLoaded() {
+      const size_t failed = TextureCache::get().getFailed();
+      if (failed) spdlog::error("Scenario '{}': {} textures failed to load", this->scenario.name, failed);
+      return failed == 0;
+    }
+
+    /* Returns the results of the run as a JSON object */
+    std::string results() {
+      const FrameSummary stats = this->frameStats.compute();
+      const size_t measured = std::max<size_t>(this->frame - this->warmup - 1, 1);
+
+      size_t rss, peak;
+      readMemory(rss, peak);
+
+      char json[1024];
+      snprintf(json, sizeof(json),
+        "{\"name\":\"%s\",\"animated\":%s,\"frames\":%zu,\"measured_frames\":%zu,\"shapes\":%zu,"
+        "\"setup_ms\":%.3f,\"triangulate_ms\":%.3f,"
+        "\"frame_ms\":{\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f},"
+        "\"cpu_ms_mean\":%.4f,\"gpu_ms_mean\":%.4f,\"hitches\":%zu,"
+        "\"draw_calls_per_frame\":%.2f,\"batches_per_frame\":%.2f,\"verticies_per_frame\":%.1f,"
+        "\"bytes_uploaded_per_frame\":%.1f,\"rss_kb\":%zu,\"peak_rss_kb\":%zu}",
+        this->scenario.name, this->scenario.animated ? "true" : "false", this->frames, stats.frames, this->shapes.size(),
+        this->setupMs, this->triangulateMs,
+        stats.mean, stats.p50, stats.p95, stats.p99, stats.max,
+        stats.cpuMean, stats.gpuMean, stats.hitches,
+        (double)this->drawCalls / measured, (double)this->batches / measured, (double)this->verticies / measured,
+        (double)this->uploaded / measured, rss, peak);
+      return json;
+    }
+};
+
+
+/* Runs a scenario in a child process, returning its results, empty on failure */
+static std::string runScenario(const Scenario &scenario, size_t frames) {
+  int fds[2];
+  if (pipe(fds) != 0) return "";
+
+  const pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+
+    std::string json;
+    {
+      BenchApp app(scenario, frames);
+      if (app.run() == 0 && app.texturesLoaded()) json = app.results();
+    }
+
+    if (!json.empty() && write(fds[1], json.data(), json.size()) < 0) _exit(1);
+    close(fds[1]);
+    _exit(json.empty() ? 1 : 0);
+  }
+  close(fds[1]);
+
+  std::string json;
+  char buffer[1024];
+  ssize_t length;
+  while ((length = read(fds[0], buffer, sizeof(buffer))) > 0)
+    json.append(buffer, length);
+  close(fds[0]);
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    spdlog::error("Scenario '{}' failed", scenario.name);
+    return "";
+  }
+  return json;
+}
+
+
+int main(int argc, char **argv) {
+  size_t frames = BENCH_FRAMES;
+  const char *output = nullptr;
+  std::vector<const Scenario*> selected;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      frames = strtoul(argv[++i], nullptr, 10);
+    }
+    else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      output = argv[++i];
+    }
+    else if (strcmp(argv[i], "--list") == 0) {
+      for (const Scenario &scenario : SCENARIOS) printf("%s\n", scenario.name);
+      return 0;
+    }
+    else {
+      auto it = std::find_if(SCENARIOS.begin(), SCENARIOS.end(), [&](const Scenario &scenario) {
+        return strcmp(scenario.name, argv[i]) == 0;
+      });
+      if (it == SCENARIOS.end()) {
+        spdlog::error("Unknown scenario '{}', see --list", argv[i]);
+        return 1;
+      }
+      selected.push_back(&*it);
+    }
+  }
+
+  if (selected.empty())
+    for (const Scenario &scenario : SCENARIOS) selected.push_back(&scenario);
+
+  std::ostringstream results;
+  results << "{\"frames\":" << frames << ",\"width\":" << BENCH_WIDTH << ",\"height\":" << BENCH_HEIGHT
+          << ",\"scenarios\":[\n";
+
+  bool failed = false, first = true;
+  for (const Scenario *scenario : selected) {
+    spdlog::info("Running '{}'...", scenario->name);
+    const std::string json = runScenario(*scenario, frames);
+    if (json.empty()) {
+      failed = true;
+      continue;
+    }
+
+    results << (first ? "  " : ",\n  ") << json;
+    first = false;
+  }
+  results << "\n]}\n";
+
+  if (output) {
+    std::ofstream file(output);
+    file << results.str();
+    if (!file.good()) {
+      spdlog::error("Failed to write '{}'", output);
+      return 1;
+    }
+    spdlog::info("Wrote results to '{}'", output);
+  }
+  else {
+    fputs(results.str().c_str(), stdout);
+  }
+
+  return failed ? 1 : 0;
+}
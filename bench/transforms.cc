@@ -0,0 +1,232 @@
+/*
+ * Microbenchmarks of the CPU geometry transforms.
+ *  Compares the per-vertex 4x4 matrix multiply the BatchRenderer used to
+ *  do against the Transform2D kernels, over vertex & point streams from
+ *  cache sized to memory sized. Each kernel's output is checked against
+ *  the matrix path first.
+ *
+ * Usage: transforms [--filter substring] [--min-time seconds] [--json]
+ *  - Reported like Google Benchmark: time per iteration, iterations &
+ *  throughput in items & bytes (read + written) per second
+ */
+#include "Transform2D.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Stream sizes, in verticies or points */
+static const size_t SIZES[] = { 64, 1024, 64 * 1024, 1024 * 1024 };
+
+/* Range of the generated coordinates */
+#define COORD_RANGE 1000.f
+
+/* Max difference with the matrix path, a few ulps of the transformed coordinates (FMA rounds differently) */
+#define TOLERANCE 1e-3f
+
+
+/* Keeps the compiler from optimizing away writes to the pointed memory */
+static inline void doNotOptimize(void *p) {
+  asm volatile("" : : "g"(p) : "memory");
+}
+
+/* Model matrix as built by Shape */
+static glm::mat4 modelMatrix() {
+  const glm::vec3 origin(120.f, 80.f, 0.f);
+  glm::mat4 m = glm::translate(glm::mat4(1.f), glm::vec3(300.f, -40.f, 0.f) + origin);
+  m = glm::rotate(m, 0.7f, glm::vec3(0.f, 0.f, 1.f));
+  m = glm::scale(m, glm::vec3(1.5f, 0.75f, 1.f));
+  return glm::translate(m, -origin);
+}
+
+
+/*
+ ***************************************************************
+ * Reference Path
+ *	- Full 4x4 multiply per vertex, as the BatchRenderer did
+ ***************************************************************
+ */
+static void verticiesMatrix(const glm::mat4 &model, const Vertex *src, Vertex *dst, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    Vertex v = src[i];
+    const glm::vec4 p = model * glm::vec4(v.x, v.y, v.z, 1.f);
+    v.x = p.x;
+    v.y = p.y;
+    v.z = p.z;
+    dst[i] = v;
+  }
+}
+
+static void pointsMatrix(const glm::mat4 &model, const glm::vec2 *src, glm::vec2 *dst, size_t count) {
+  for (size_t i = 0; i < count; i++)
+    dst[i] = glm::vec2(model * glm::vec4(src[i], 0.f, 1.f));
+}
+
+
+/*
+ ***************************************************************
+ * Harness
+ *	- Iterations grow until a run takes the min time
+ ***************************************************************
+ */
+struct Result {
+  std::string name;
+  double ns;              // Time per iteration
+  size_t iterations;
+  double items;           // Items per second
+  double bytes;           // Bytes read & written per second
+};
+
+static Result measure(const std::string &name, size_t items, size_t bytes, double minTime, const std::function<void()> &fn) {
+  using Clock = std::chrono::steady_clock;
+  fn();   // Warm up caches & page in the buffers.
+
+  size_t iterations = 1;
+  double elapsed = 0.0;
+  while (true) {
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < iterations; i++) fn();
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (elapsed >= minTime || iterations >= (1ull << 30)) break;
+    iterations *= elapsed > minTime / 10.0 ? (size_t)std::ceil(minTime * 1.4 / elapsed) : 10;
+  }
+
+  return { name, elapsed * 1e9 / iterations, iterations, items * iterations / elapsed, bytes * iterations / elapsed };
+}
+
+static bool isClose(float a, float b) {
+  return std::fabs(a - b) <= TOLERANCE;
+}
+
+static bool checkPoints(const char *name, const glm::vec2 *result, const glm::vec2 *expected, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (!isClose(result[i].x, expected[i].x) || !isClose(result[i].y, expected[i].y)) {
+      fprintf(stderr, "%s: mismatch at %zu\n", name, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Positions within tolerance, every other attribute copied bit for bit */
+static bool checkVerticies(const char *name, const Vertex *result, const Vertex *expected, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (!isClose(result[i].x, expected[i].x) || !isClose(result[i].y, expected[i].y) ||
+        memcmp(&result[i].z, &expected[i].z, sizeof(Vertex) - offsetof(Vertex, z)) != 0) {
+      fprintf(stderr, "%s: mismatch at %zu\n", name, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+
+int main(int argc, char **argv) {
+  const char *filter = nullptr;
+  double minTime = 0.2;
+  bool json = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+    else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) minTime = atof(argv[++i]);
+    else if (strcmp(argv[i], "--json") == 0) json = true;
+    else {
+      fprintf(stderr, "Usage: %s [--filter substring] [--min-time seconds] [--json]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  const glm::mat4 model = modelMatrix();
+  const Affine2D affine = Affine2D::from_matrix(model);
+  const Transform2D::Kernel kernels[] = { Transform2D::Kernel::Scalar, Transform2D::Kernel::SSE2, Transform2D::Kernel::AVX2 };
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> coord(-COORD_RANGE, COORD_RANGE);
+
+  std::vector<Result> results;
+  bool failed = false;
+  auto run = [&](const std::string &name, size_t items, size_t bytes, const std::function<void()> &fn) {
+    if (filter && name.find(filter) == std::string::npos) return;
+    results.push_back(measure(name, items, bytes, minTime, fn));
+    if (!json) {
+      const Result &r = results.back();
+      printf("%-32s %14.1f ns %12zu %10.2f M items/s %9.2f GB/s\n", r.name.c_str(), r.ns, r.iterations, r.items * 1e-6, r.bytes * 1e-9);
+    }
+  };
+
+  if (!json) {
+    printf("%-32s %17s %12s %20s %14s\n", "Benchmark", "Time", "Iterations", "Items", "Bytes");
+    printf("%s\n", std::string(99, '-').c_str());
+  }
+
+  for (size_t size : SIZES) {
+    std::vector<Vertex> srcVerticies(size), dstVerticies(size), expectedVerticies(size);
+    std::vector<glm::vec2> srcPoints(size), dstPoints(size), expectedPoints(size);
+    for (size_t i = 0; i < size; i++) {
+      srcVerticies[i] = Vertex(coord(rng), coord(rng), 0.0, i & 0xff, 64, 128, 255, 0.25, (i & 0xff) / 255.0);
+      srcPoints[i] = { coord(rng), coord(rng) };
+    }
+    verticiesMatrix(model, srcVerticies.data(), expectedVerticies.data(), size);
+    pointsMatrix(model, srcPoints.data(), expectedPoints.data(), size);
+
+    const std::string suffix = "/" + std::to_string(size);
+    const size_t vertexBytes = size * sizeof(Vertex) * 2;
+    const size_t pointBytes = size * sizeof(glm::vec2) * 2;
+
+    run("verticies/mat4" + suffix, size, vertexBytes, [&]() {
+      verticiesMatrix(model, srcVerticies.data(), dstVerticies.data(), size);
+      doNotOptimize(dstVerticies.data());
+    });
+
+    for (Transform2D::Kernel kernel : kernels) {
+      if (!Transform2D::set_kernel(kernel)) continue;
+      const std::string name = std::string("verticies/") + Transform2D::kernel_name(kernel) + suffix;
+
+      Transform2D::verticies(affine, srcVerticies.data(), dstVerticies.data(), size);
+      if (!checkVerticies(name.c_str(), dstVerticies.data(), expectedVerticies.data(), size)) failed = true;
+
+      run(name, size, vertexBytes, [&]() {
+        Transform2D::verticies(affine, srcVerticies.data(), dstVerticies.data(), size);
+        doNotOptimize(dstVerticies.data());
+      });
+    }
+
+    run("points/mat4" + suffix, size, pointBytes, [&]() {
+      pointsMatrix(model, srcPoints.data(), dstPoints.data(), size);
+      doNotOptimize(dstPoints.data());
+    });
+
+    for (Transform2D::Kernel kernel : kernels) {
+      if (!Transform2D::set_kernel(kernel)) continue;
+      const std::string name = std::string("points/") + Transform2D::kernel_name(kernel) + suffix;
+
+      Transform2D::points(affine, srcPoints.data(), dstPoints.data(), size);
+      if (!checkPoints(name.c_str(), dstPoints.data(), expectedPoints.data(), size)) failed = true;
+
+      run(name, size, pointBytes, [&]() {
+        Transform2D::points(affine, srcPoints.data(), dstPoints.data(), size);
+        doNotOptimize(dstPoints.data());
+      });
+    }
+  }
+
+  if (json) {
+    printf("{\"benchmarks\":[\n");
+    for (size_t i = 0; i < results.size(); i++) {
+      const Result &r = results[i];
+      printf("  {\"name\":\"%s\",\"real_time_ns\":%.2f,\"iterations\":%zu,\"items_per_second\":%.1f,\"bytes_per_second\":%.1f}%s\n",
+        r.name.c_str(), r.ns, r.iterations, r.items, r.bytes, i + 1 < results.size() ? "," : "");
+    }
+    printf("]}\n");
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+#version 460 core
+/*
+ * Instanced Fragment Shader, tints the texture (or solid color) per instance
+ */
+
+/* Shader Settings */
+precision mediump float;    // Set precision to Medium
+
+/* Incomming Data */
+in vec4 vertexColor;		// Tint of the Instance
+in vec2 textureCoord;		// Texture Coordinates
+flat in float textureLayer;	// Texture Layer (Reserved for layered textures)
+
+/* Outbound Data */
+out vec4 FragColor;			// Color of Object -> Apply
+
+/* Uniform Data */
+uniform sampler2D textureSampler;
+uniform bool useTexture;     // Flag to use a texture instead of the tint only.
+
+
+
+void main() {
+  // Apply the tinted texture onto the pixel.
+  if (useTexture) {
+    FragColor = texture(textureSampler, textureCoord) * vertexColor;
+  }
+
+  // Use the instance's tint.
+  else {
+    FragColor = vertexColor;
+  }
+}
@@ -0,0 +1,69 @@
+#version 460 core
+/*
+ * Instanced Vertex Shader, places a shared mesh using per-instance attributes
+ */
+
+
+/* Incomming Data */
+layout (location = 0) in vec3 aPos;		// Position of Variable from Location 0
+layout (location = 1) in vec4 aRGBA;		// RGBA Color of Vertex
+layout (location = 2) in vec2 aTextCoord;	// Texture Drawn Coordinate
+
+/* Incomming Instance Data */
+layout (location = 3) in vec3 iRow0;		// First row of the 2x3 affine transform
+layout (location = 4) in vec3 iRow1;		// Second row of the 2x3 affine transform
+layout (location = 5) in vec4 iTint;		// Tint of the Instance
+layout (location = 6) in float iLayer;	// Texture Layer of the Instance
+
+/* Outbound Data */
+out vec4 vertexColor;						// Vector of Color outputing to Fragment Shader
+out vec2 textureCoord;					// Texture Coordinates
+flat out float textureLayer;		// Texture Layer
+
+/* Uniform Data */
+
+/* Per-frame Uniform Data, shared by all programs */
+layout (std140, binding = 0) uniform FrameData {
+  mat4 transform;
+  vec2 u_res;
+  vec2 u_mouse;
+  float u_time;
+};
+
+/**
+ * Normalizes a given value from one range to another range.
+ *
+ * @param v Value with old range.
+ * @param oldMin Old minimum range.
+ * @param oldMax Old maximum range.
+ * @param newMin New minimum range.
+ * @param newMax New maximum range.
+ *
+ * @returns Old value mapped to the new range.
+*/
+float normalizeFloat(const float v, const float oldMin, const float oldMax, const float newMin, const float newMax) {
+  float oldRange = oldMax - oldMin;
+  float newRange = newMax - newMin;
+  return (((v - oldMin) * newRange) / oldRange) + newMin;
+}
+
+void main() {
+  // Apply the instance's affine transform on the shared mesh.
+  vec2 world = vec2(
+    dot(iRow0, vec3(aPos.xy, 1.0f)),
+    dot(iRow1, vec3(aPos.xy, 1.0f))
+  );
+
+  vec3 pos = vec3(
+    normalizeFloat( world.x, 0.f, u_res.x, -1.f, 1.f ),
+    normalizeFloat( world.y, 0.f, u_res.y, -1.f, 1.f ),
+    aPos.z
+  );
+
+  gl_Position = transform * vec4(pos, 1.0f);
+
+  // Outbound Data
+  vertexColor = iTint;
+  textureCoord = aTextCoord;
+  textureLayer = iLayer;
+}
@@ -0,0 +1,51 @@
+#version 460 core
+/*
+ * Fragment Shader for SDF circles/ellipses, drawn as a single quad
+ *  where the texture coordinates span the bounding box.
+ */
+
+/* Shader Settings */
+precision mediump float;    // Set precision to Medium
+
+/* Incomming Data */
+in vec4 vertexColor;		// Color from Vertex -> Given to Fragment to Apply
+in vec2 textureCoord;		// Texture Coordinates
+
+/* Outbound Data */
+out vec4 FragColor;			// Color of Object -> Apply
+
+/* Uniform Data */
+uniform sampler2D textureSampler;
+uniform bool useTexture;     // Flag to use a texture instead of a solid color.
+uniform vec4 solidColor;
+
+/* Per-frame Uniform Data, shared by all programs */
+layout (std140, binding = 0) uniform FrameData {
+  mat4 transform;
+  vec2 u_res;
+  vec2 u_mouse;
+  float u_time;
+};
+
+
+void main() {
+  // Map the bounding box into [-1, 1], where the ellipse becomes a unit circle.
+  vec2 p = textureCoord * 2.0f - 1.0f;
+
+  // Signed distance to the edge, negative inside.
+  float dist = length(p) - 1.0f;
+
+  // Screen-space rate of change of the distance, resolves the edge
+  // within a single pixel regardless of zoom, scale or rotation.
+  float aa = max(fwidth(dist), 1e-5f);
+  float coverage = clamp(0.5f - dist / aa, 0.0f, 1.0f);
+
+  if (coverage <= 0.0f)
+    discard;
+
+  vec4 color = useTexture
+    ? texture(textureSampler, textureCoord)
+    : clamp(solidColor, 0.0f, 1.0f);
+
+  FragColor = vec4(color.rgb, color.a * coverage);
+}
@@ -16,9 +16,14 @@ out vec4 FragColor;			// Color of Object -> Apply
 
 /* Uniform Data */
 uniform sampler2D textureSampler;
-uniform float u_time;
-uniform vec2 u_mouse;
-uniform vec2 u_res;
+
+/* Per-frame Uniform Data, shared by all programs */
+layout (std140, binding = 0) uniform FrameData {
+  mat4 transform;
+  vec2 u_res;
+  vec2 u_mouse;
+  float u_time;
+};
 
 
 void main() {
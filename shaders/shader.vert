@@ -6,16 +6,23 @@
 
 /* Incomming Data */
 layout (location = 0) in vec3 aPos;		// Position of Variable from Location 0
-in vec4 aRGBA;												// RGBA Color of Vertex
-in vec2 aTextCoord;										// Texture Drawn Coordinate
+layout (location = 1) in vec4 aRGBA;		// RGBA Color of Vertex
+layout (location = 2) in vec2 aTextCoord;	// Texture Drawn Coordinate
 
 /* Outbound Data */
 out vec4 vertexColor;						// Vector of Color outputing to Fragment Shader
 out vec2 textureCoord;					// Texture Coordinates
 
 /* Uniform Data */
-uniform mat4 transform;
-uniform vec2 u_res;
+uniform mat4 model = mat4(1.0f);	// Shape's local -> world transform
+
+/* Per-frame Uniform Data, shared by all programs */
+layout (std140, binding = 0) uniform FrameData {
+  mat4 transform;
+  vec2 u_res;
+  vec2 u_mouse;
+  float u_time;
+};
 
 /**
  * Normalizes a given value from one range to another range.
@@ -43,10 +50,13 @@ float normalizeFloat(const float v, const float oldMin, const float oldMax, cons
 }
 
 void main() {
+  // Apply the shape's model transform on the local geometry.
+  vec4 world = model * vec4(aPos, 1.0f);
+
   vec3 pos = vec3(
-    normalizeFloat( aPos.x, 0.f, u_res.x, -1.f, 1.f ),
-    normalizeFloat( aPos.y, 0.f, u_res.y, -1.f, 1.f ),
-    aPos.z
+    normalizeFloat( world.x, 0.f, u_res.x, -1.f, 1.f ),
+    normalizeFloat( world.y, 0.f, u_res.y, -1.f, 1.f ),
+    world.z
   );
 
   gl_Position = transform * vec4(pos, 1.0f);
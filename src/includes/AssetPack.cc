@@ -0,0 +1,240 @@
+#include "AssetPack.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/*
+ ***************************************************************
+ * Constructors & Destructors
+ *	- Pack is shared, mounted once for the whole process
+ ***************************************************************
+ */
+AssetPack::AssetPack() :
+  mapping(nullptr),
+  mappingSize(0),
+  header(nullptr),
+  entries(nullptr),
+  names(nullptr) {}
+
+AssetPack::~AssetPack() {
+  this->close();
+}
+
+AssetPack& AssetPack::get() {
+  static AssetPack pack;
+  return pack;
+}
+
+
+/*
+ ***************************************************************
+ * Helpers
+ ***************************************************************
+ */
+std::string AssetPack::normalize(const std::string &path) {
+  size_t start = 0;
+  while (path.compare(start, 2, "./") == 0) start += 2;
+  return path.substr(start);
+}
+
+uint64_t AssetPack::hash(const std::string &path) {
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (unsigned char c : path) {
+    h ^= c;
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+
+/*
+ ***************************************************************
+ * Mapping & Lookups
+ *	- The whole pack is mapped read-only with one open & mmap,
+ *	read ahead since most of it is used at startup
+ ***************************************************************
+ */
+bool AssetPack::open(const std::string &path) {
+  this->close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    spdlog::error("AssetPack: Failed to open '{}'", path);
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+    spdlog::error("AssetPack: '{}' is not a pack", path);
+    ::close(fd);
+    return false;
+  }
+
+  void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // The mapping keeps the file alive.
+  if (mapped == MAP_FAILED) {
+    spdlog::error("AssetPack: Failed to map '{}'", path);
+    return false;
+  }
+  madvise(mapped, st.st_size, MADV_WILLNEED);
+
+  this->mapping = static_cast<const unsigned char*>(mapped);
+  this->mappingSize = st.st_size;
+  this->header = reinterpret_cast<const Header*>(this->mapping);
+
+  // Validate the tables before handing out pointers into them.
+  const Header &h = *this->header;
+  const bool valid =
+    memcmp(h.magic, ASSET_PACK_MAGIC, 4) == 0 &&
+    h.version == ASSET_PACK_VERSION &&
+    h.indexOffset + (uint64_t)h.count * sizeof(Entry) <= this->mappingSize &&
+    h.namesOffset <= this->mappingSize;
+  if (!valid) {
+    spdlog::error("AssetPack: '{}' is not a version {} pack", path, ASSET_PACK_VERSION);
+    this->close();
+    return false;
+  }
+
+  this->entries = reinterpret_cast<const Entry*>(this->mapping + h.indexOffset);
+  this->names = reinterpret_cast<const char*>(this->mapping + h.namesOffset);
+
+  for (uint32_t i = 0; i < h.count; i++) {
+    const Entry &e = this->entries[i];
+    if (e.offset + e.size > this->mappingSize ||
+        h.namesOffset + e.nameOffset + e.nameLength > this->mappingSize) {
+      spdlog::error("AssetPack: '{}' is truncated", path);
+      this->close();
+      return false;
+    }
+  }
+
+  spdlog::info("AssetPack: Mounted '{}', {} assets", path, h.count);
+  return true;
+}
+
+void AssetPack::close() {
+  if (this->mapping)
+    munmap(const_cast<unsigned char*>(this->mapping), this->mappingSize);
+
+  this->mapping = nullptr;
+  this->mappingSize = 0;
+  this->header = nullptr;
+  this->entries = nullptr;
+  this->names = nullptr;
+}
+
+bool AssetPack::isOpen() const {
+  return this->mapping != nullptr;
+}
+
+bool AssetPack::find(const std::string &path, Asset &asset) const {
+  if (!this->mapping) return false;
+
+  const std::string name = normalize(path);
+  const uint64_t h = hash(name);
+
+  const Entry *end = this->entries + this->header->count;
+  const Entry *it = std::lower_bound(this->entries, end, h, [](const Entry &e, uint64_t value) {
+    return e.hash < value;
+  });
+
+  // Colliding hashes are adjacent, compare their paths.
+  for (; it != end && it->hash == h; it++) {
+    if (it->nameLength == name.size() && memcmp(this->names + it->nameOffset, name.data(), name.size()) == 0) {
+      asset = { this->mapping + it->offset, (size_t)it->size };
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t AssetPack::size() const {
+  return this->header ? this->header->count : 0;
+}
+
+
+/*
+ ***************************************************************
+ * Packing
+ *	- Sizes are known up front, so the tables are written first
+ *	& each file is streamed straight to its aligned offset
+ ***************************************************************
+ */
+bool AssetPack::write(const std::string &output, const std::vector<std::string> &paths) {
+  struct Source {
+    std::string path;   // Path on disk
+    std::string name;   // Normalized path stored in the pack
+    Entry entry;
+  };
+
+  std::vector<Source> sources;
+  for (const std::string &path : paths) {
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    if (error) {
+      spdlog::error("AssetPack: Failed to read '{}': {}", path, error.message());
+      return false;
+    }
+
+    const std::string name = normalize(path);
+    sources.push_back({ path, name, { hash(name), 0, size, 0, (uint32_t)name.size() } });
+  }
+
+  std::sort(sources.begin(), sources.end(), [](const Source &a, const Source &b) {
+    return a.entry.hash != b.entry.hash ? a.entry.hash < b.entry.hash : a.name < b.name;
+  });
+
+  // Lay out the tables, then the blobs.
+  Header header {};
+  memcpy(header.magic, ASSET_PACK_MAGIC, 4);
+  header.version = ASSET_PACK_VERSION;
+  header.count = sources.size();
+  header.alignment = ASSET_PACK_ALIGNMENT;
+  header.indexOffset = sizeof(Header);
+  header.namesOffset = header.indexOffset + sources.size() * sizeof(Entry);
+
+  uint64_t offset = header.namesOffset;
+  for (Source &source : sources) {
+    source.entry.nameOffset = offset - header.namesOffset;
+    offset += source.name.size();
+  }
+  for (Source &source : sources) {
+    offset = (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+    source.entry.offset = offset;
+    offset += source.entry.size;
+  }
+
+  std::ofstream file(output, std::ios::binary);
+  if (!file) {
+    spdlog::error("AssetPack: Failed to open '{}'", output);
+    return false;
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const Source &source : sources)
+    file.write(reinterpret_cast<const char*>(&source.entry), sizeof(Entry));
+  for (const Source &source : sources)
+    file.write(source.name.data(), source.name.size());
+
+  uint64_t written = header.namesOffset;
+  for (const Source &source : sources) written += source.name.size();
+
+  const char zeros[ASSET_PACK_ALIGNMENT] = {};
+  for (const Source &source : sources) {
+    file.write(zeros, source.entry.offset - written);
+
+    std::ifstream in(source.path, std::ios::binary);
+    if (source.entry.size > 0) file << in.rdbuf();
+    written = source.entry.offset + source.entry.size;
+  }
+
+  return file.good();
+}
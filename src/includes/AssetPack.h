@@ -0,0 +1,104 @@
+#pragma once
+
+// Core libraries
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/* Pack files start with these bytes, followed by the format version */
+#define ASSET_PACK_MAGIC "SRPK"
+#define ASSET_PACK_VERSION 1
+
+/* Alignment of each blob within the pack, in bytes */
+#define ASSET_PACK_ALIGNMENT 64
+
+
+/* Contents of a packed asset, pointing into the mapped pack */
+struct Asset {
+  const unsigned char *data;
+  size_t size;
+};
+
+
+/**
+ * Read-only archive of assets, memory mapped as a whole.
+ *  [ Header   Index (sorted by path hash)   Path names   Aligned blobs ]
+ *
+ * Assets are looked up by path, leading "./" ignored, and handed out
+ *  as pointers into the mapping, so loading an asset never copies it.
+ *  Shaders & Textures look in the mounted pack before the filesystem.
+ */
+class AssetPack {
+  private:
+    struct Header {
+      char magic[4];
+      uint32_t version;
+      uint32_t count;           // Number of assets
+      uint32_t alignment;       // Alignment of the blobs
+      uint64_t indexOffset;     // Offset of the Entry table
+      uint64_t namesOffset;     // Offset of the path names
+    };
+
+    struct Entry {
+      uint64_t hash;            // FNV-1a hash of the path
+      uint64_t offset;          // Offset of the blob
+      uint64_t size;            // Size of the blob
+      uint32_t nameOffset;      // Offset of the path, from namesOffset
+      uint32_t nameLength;
+    };
+
+  private:
+    const unsigned char *mapping;
+    size_t mappingSize;
+    const Header *header;
+    const Entry *entries;
+    const char *names;
+
+  private:
+    /* Strips the leading "./" so both spellings of a path match */
+    static std::string normalize(const std::string &path);
+
+    /* 64-bit FNV-1a hash of a normalized path */
+    static uint64_t hash(const std::string &path);
+
+  public:
+    AssetPack();
+    ~AssetPack();
+
+    /* Returns the pack mounted for the whole process */
+    static AssetPack& get();
+
+    /**
+     * Maps a pack file, replacing the previously opened one.
+     *	@param path - Location of the pack
+     *	@returns Whether the pack is valid
+     */
+    bool open(const std::string &path);
+
+    /* Unmaps the pack. Pointers handed out become invalid */
+    void close();
+
+    /* Returns whether a pack is mapped */
+    bool isOpen() const;
+
+    /**
+     * Looks up an asset by path.
+     *	@param path - Path of the asset, as given to the packer
+     *	@param asset - Set to the asset's contents if found
+     *	@returns Whether the asset is in the pack
+     */
+    bool find(const std::string &path, Asset &asset) const;
+
+    /* Returns the number of packed assets */
+    size_t size() const;
+
+    /**
+     * Writes a pack holding the given files, offline.
+     *	@param output - Pack file to write
+     *	@param paths - Files to pack, stored under the given paths
+     *	@returns Whether the pack was written
+     */
+    static bool write(const std::string &output, const std::vector<std::string> &paths);
+};
@@ -0,0 +1,196 @@
+#include "BatchRenderer.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "Transform2D.h"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+
+/*
+ ***************************************************************
+ * Constructors & GL Resources
+ *	- Constructor
+ *		- Configures the batch capacities
+ *	- Initialize & Destroy the streaming GL Objects
+ ***************************************************************
+ */
+BatchRenderer::BatchRenderer(size_t maxVerticies, size_t maxIndicies) :
+  VAO(0),
+  vertexStream(GL_ARRAY_BUFFER, maxVerticies * sizeof(Vertex)),
+  indexStream(GL_ELEMENT_ARRAY_BUFFER, maxIndicies * sizeof(GLuint)),
+  vertexCapacity(maxVerticies),
+  indexCapacity(maxIndicies) {}
+
+void BatchRenderer::init() {
+  glGenVertexArrays(1, &this->VAO);
+
+  // Index buffer binding is stored in the VAO, so bind it first.
+  GLState::bindVertexArray(this->VAO);
+  this->vertexStream.init();
+  this->indexStream.init();
+  this->bindStreams();
+
+  if (!this->vertexStream.isPersistent())
+    spdlog::warn("BatchRenderer: Buffer storage not supported, streaming through buffer orphaning");
+}
+
+void BatchRenderer::destroy() {
+  GLState::bindVertexArray(this->VAO);
+  this->vertexStream.destroy();
+  this->indexStream.destroy();
+  GLState::deleteVertexArray(this->VAO);
+  this->VAO = 0;
+}
+
+void BatchRenderer::bindStreams() {
+  GLState::bindVertexArray(this->VAO);
+  GLState::bindBuffer(GL_ARRAY_BUFFER, this->vertexStream.getID());
+  GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indexStream.getID());
+
+  // Packed layout uses fixed attribute locations, no program needed.
+  VertexLayout::packed().apply(0);
+}
+
+void BatchRenderer::reserve(size_t vertexCount, size_t indexCount) {
+  if (vertexCount <= this->vertexCapacity && indexCount <= this->indexCapacity) return;
+
+  this->vertexCapacity = std::max(vertexCount, this->vertexCapacity);
+  this->indexCapacity = std::max(indexCount, this->indexCapacity);
+  spdlog::warn("BatchRenderer: Growing batch capacity to {} verticies / {} indicies", this->vertexCapacity, this->indexCapacity);
+
+  GLState::bindVertexArray(this->VAO);
+  this->vertexStream.reserve(this->vertexCapacity * sizeof(Vertex));
+  this->indexStream.reserve(this->indexCapacity * sizeof(GLuint));
+  this->bindStreams();
+}
+
+
+/*
+ ***************************************************************
+ * Batching
+ *	- Submit Shapes, merging them into the last batch if the
+ *	state matches
+ *	- Flush all batches, one draw call per batch
+ ***************************************************************
+ */
+void BatchRenderer::submit(Shape *shape) {
+  const BufferData &bd = shape->buffer;
+  const GLuint textureID = bd.texture ? bd.texture->textureID : 0;
+  const BlendMode blend = shape->get_blend_mode();
+
+  // Start a new batch on any state change.
+  if (this->batches.empty() ||
+      this->batches.back().shader->ID != bd.shader->ID ||
+      (this->batches.back().texture ? this->batches.back().texture->textureID : 0) != textureID ||
+      this->batches.back().blend != blend) {
+    this->batches.push_back({ bd.shader, bd.texture.get(), blend, {} });
+  }
+
+  this->batches.back().shapes.push_back(shape);
+}
+
+void BatchRenderer::drawShapes(Shape **begin, Shape **end, size_t vertexCount, size_t indexCount) {
+  if (indexCount == 0) return;
+
+  // Reserve space in the streaming buffers, written to directly.
+  size_t vertexOffset, indexOffset;
+  Vertex *verticies = (Vertex*)this->vertexStream.map(vertexCount * sizeof(Vertex), sizeof(Vertex), vertexOffset);
+  GLuint *indicies = (GLuint*)this->indexStream.map(indexCount * sizeof(GLuint), sizeof(GLuint), indexOffset);
+  if (!verticies || !indicies) {
+    // Don't leave the other stream mapped, drawing would fail on it.
+    if (verticies) this->vertexStream.unmap();
+    if (indicies) this->indexStream.unmap();
+    spdlog::error("BatchRenderer: Failed to map the streams, skipping {} verticies", vertexCount);
+    return;
+  }
+
+  GLuint baseVertex = 0;
+  for (Shape **it = begin; it != end; it++) {
+    Shape *shape = *it;
+    const BufferData &bd = shape->buffer;
+    const size_t shapeVerticies = bd.vertex_count();
+
+    // Transform the local geometry into world space, straight into the stream.
+    const Affine2D model = Affine2D::from_matrix(shape->get_model_matrix());
+    Transform2D::verticies(model, bd.vertex_buffer_ptr, verticies, shapeVerticies);
+    verticies += shapeVerticies;
+
+    for (size_t i = 0; i < bd.indiciesElts; i++)
+      *indicies++ = baseVertex + bd.index_buffer_ptr[i];
+
+    baseVertex += shapeVerticies;
+  }
+
+  this->vertexStream.unmap();
+  this->indexStream.unmap();
+
+  // Indicies are relative to the chunk's first vertex.
+  glDrawElementsBaseVertex(
+    GL_TRIANGLES,
+    indexCount,
+    GL_UNSIGNED_INT,
+    (void*)indexOffset,
+    vertexOffset / sizeof(Vertex)
+  );
+
+  this->stats.drawCalls++;
+  this->stats.verticies += vertexCount;
+  this->stats.indicies += indexCount;
+}
+
+void BatchRenderer::flush(const BatchCallback &onBatch) {
+  this->stats = BatchStats();
+  this->stats.batches = this->batches.size();
+
+  const glm::mat4 identity(1.f);
+  GLState::bindVertexArray(this->VAO);
+
+  for (Batch &batch : this->batches) {
+    PROFILE_SCOPE("Batch");
+
+    // Activate the bound shader program & blending.
+    batch.shader->use();
+    GLState::setBlendMode(batch.blend);
+
+    // Verticies are already in world space.
+    batch.shader->setUniform("model", identity);
+
+    // Bind the Texture
+    if (batch.texture) batch.texture->bind(0);
+    if (onBatch) onBatch(batch.shader.get(), batch.texture);
+
+    // Split the batch into chunks fitting in a single draw call.
+    Shape **chunk = batch.shapes.data();
+    Shape **end = chunk + batch.shapes.size();
+    size_t vertexCount = 0, indexCount = 0;
+
+    for (Shape **it = chunk; it != end; it++) {
+      const BufferData &bd = (*it)->buffer;
+      const size_t shapeVerticies = bd.vertex_count();
+      const size_t shapeIndicies = bd.indiciesElts;
+
+      // Shape doesn't fit in what's left of the chunk.
+      if (vertexCount + shapeVerticies > this->vertexCapacity ||
+          indexCount + shapeIndicies > this->indexCapacity) {
+        this->drawShapes(chunk, it, vertexCount, indexCount);
+        this->reserve(shapeVerticies, shapeIndicies);
+        chunk = it;
+        vertexCount = indexCount = 0;
+      }
+
+      vertexCount += shapeVerticies;
+      indexCount += shapeIndicies;
+      this->stats.shapes++;
+    }
+
+    this->drawShapes(chunk, end, vertexCount, indexCount);
+  }
+
+  // Batches are rebuilt every frame.
+  this->batches.clear();
+}
+
+const BatchStats& BatchRenderer::getStats() const {
+  return this->stats;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+// Library
+#include "BufferData.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "Texture.h"
+#include "shapes/Shape.h"
+
+// Core libraries
+#include <GL/glew.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+/* Statistics of the last flushed frame */
+struct BatchStats {
+  size_t batches   = 0;   // Number of (Shader, Texture, Blend) batches
+  size_t drawCalls = 0;   // Number of draw calls issued (Batches can be split)
+  size_t shapes    = 0;   // Number of submitted shapes
+  size_t verticies = 0;   // Number of verticies streamed
+  size_t indicies  = 0;   // Number of indicies streamed
+};
+
+/**
+ * Gathers Shapes sharing the same Shader, Texture & Blend Mode
+ *  into a single streaming Vertex/Index buffer, issuing one draw
+ *  call per batch instead of one per Shape.
+ *
+ * Shapes are drawn in submission order, consecutive Shapes sharing
+ *  the same state are merged into a batch. Submit them sorted by
+ *  state (See RenderQueue) to get the fewest batches.
+ *
+ * Verticies are transformed into world space on the CPU using
+ *  each Shape's model transform, written straight into the mapped
+ *  Stream Buffers, so batches are drawn with an identity model
+ *  transform. The transform is the 2D affine part of the model,
+ *  applied by the SIMD kernels in Transform2D.
+ */
+class BatchRenderer {
+  public:
+    /**
+     * Called once per batch, after the shader is in use and the texture is bound.
+     *  Used to update any uniforms for the batch.
+     */
+    typedef std::function<void(Shader*, Texture*)> BatchCallback;
+
+  private:
+    struct Batch {
+      std::shared_ptr<Shader> shader;
+      Texture *texture;
+      BlendMode blend;
+      std::vector<Shape*> shapes;
+    };
+
+  private:
+    GLuint VAO;                           // Vertex Array Object bound to the streaming buffers
+    StreamBuffer vertexStream;            // Streaming Vertex Buffer
+    StreamBuffer indexStream;             // Streaming Index Buffer
+    size_t vertexCapacity;                // Max number of verticies per draw call
+    size_t indexCapacity;                 // Max number of indicies per draw call
+
+    std::vector<Batch> batches;           // Batches in submission order
+
+    BatchStats stats;                     // Statistics of the last flush
+
+  private:
+    /* Points the VAO's attributes & index buffer at the streaming buffers */
+    void bindStreams();
+
+    /* Writes the Shapes in [begin, end) into the streaming buffers and draws them */
+    void drawShapes(Shape **begin, Shape **end, size_t vertexCount, size_t indexCount);
+
+    /* Grows the streaming buffers to hold the given number of elements */
+    void reserve(size_t vertexCount, size_t indexCount);
+
+  public:
+    /**
+     * Constructs the Batch Renderer. GL Objects are created on init().
+     *	@param maxVerticies - Number of verticies per draw call
+     *	@param maxIndicies - Number of indicies per draw call
+     */
+    BatchRenderer(size_t maxVerticies = 65536, size_t maxIndicies = 65536 * 3);
+
+    /* Creates the streaming buffers. Requires a current GL Context */
+    void init();
+
+    /* Releases the GL Objects. Requires a current GL Context */
+    void destroy();
+
+    /* Queues a Shape to be drawn on the next flush */
+    void submit(Shape*);
+
+    /**
+     * Draws all the submitted Shapes, one draw call per batch.
+     *	@param onBatch - Optional callback used to set per batch uniforms
+     */
+    void flush(const BatchCallback &onBatch = nullptr);
+
+    /* Returns the statistics of the last flush */
+    const BatchStats& getStats() const;
+};
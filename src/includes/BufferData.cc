@@ -1,5 +1,55 @@
 #include "BufferData.h"
+#include "GLState.h"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+
+/*
+ ***************************************************************
+ * Vertex Layout
+ *	- Describes the attributes of a single vertex
+ *	- Packed Layout matching the Vertex structure
+ ***************************************************************
+ */
+VertexLayout::VertexLayout(GLsizei stride) : stride(stride), attributes({}) {}
+
+VertexLayout& VertexLayout::add(const char *name, GLint location, GLint size, GLenum type, GLboolean normalized, GLsizei offset) {
+  this->attributes.push_back({ name, location, size, type, normalized, offset });
+  return *this;
+}
+
+void VertexLayout::apply(GLuint programID) const {
+  for (const VertexAttribute &attr : this->attributes) {
+    GLint location = attr.location >= 0
+      ? attr.location
+      : glGetAttribLocation(programID, attr.name);
+
+    // Attribute not used by the shader program, nothing to configure.
+    if (location < 0) continue;
+
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(
+      location,                     // Which Index Attribute to Configure
+      attr.size,                    // Number of Values per Vertex
+      attr.type,                    // Type of Data in the Array
+      attr.normalized,              // Normalize?
+      this->stride,                 // Stride till next Vertex
+      (void*)(size_t)attr.offset    // Offset of the attribute within the Vertex
+    );
+  }
+}
+
+VertexLayout VertexLayout::packed() {
+  VertexLayout layout(sizeof(Vertex));
+  layout
+    .add("aPos",        0, 3, GL_FLOAT,         GL_FALSE, offsetof(Vertex, x))
+    .add("aRGBA",       1, 4, GL_UNSIGNED_BYTE, GL_TRUE,  offsetof(Vertex, r))
+    .add("aTextCoord",  2, 2, GL_FLOAT,         GL_FALSE, offsetof(Vertex, u));
+  return layout;
+}
+
 
 /*
  ***************************************************************
@@ -18,6 +68,7 @@ BufferData::BufferData() {
   this->indiciesBuffer = 0;
   this->texture = nullptr;
   this->shader = nullptr;
+  this->usage = GL_STATIC_DRAW;
   this->vertex_buffer_ptr = nullptr;
   this->index_buffer_ptr = nullptr;
 }
@@ -28,17 +79,17 @@ BufferData::BufferData(GLuint& _vertBuffer, GLuint& _indBuffer, GLuint& _vao) {
   this->indiciesBuffer = _indBuffer;
   this->texture = nullptr;
   this->shader = nullptr;
+  this->usage = GL_STATIC_DRAW;
   this->vertex_buffer_ptr = nullptr;
   this->index_buffer_ptr = nullptr;
 }
 
 void BufferData::freeBufferData(BufferData* buffer) {
-  glDeleteVertexArrays(1, &buffer->VAO);
-  glDeleteBuffers(1, &buffer->verticiesBuffer);
-  glDeleteBuffers(1, &buffer->indiciesBuffer);
+  GLState::deleteVertexArray(buffer->VAO);
+  GLState::deleteBuffer(buffer->verticiesBuffer);
+  GLState::deleteBuffer(buffer->indiciesBuffer);
 
-  if (buffer->texture)
-    delete buffer->texture;
+  buffer->texture.reset();
 
   if (buffer->vertex_buffer_ptr)
     delete[] buffer->vertex_buffer_ptr;
@@ -47,20 +98,104 @@ void BufferData::freeBufferData(BufferData* buffer) {
     delete[] buffer->index_buffer_ptr;
 }
 
+void BufferData::mark_verticies_dirty(size_t first, size_t count) {
+  const size_t total = this->vertex_count();
+  if (!this->has_gpu_store() || first >= total || !count) return;
+  this->dirty_verticies.push_back({ first, std::min(count, total - first) });
+}
+
+void BufferData::mark_indicies_dirty(size_t first, size_t count) {
+  const size_t total = this->index_buffer_size_bytes / sizeof(GLuint);
+  if (!this->has_gpu_store() || first >= total || !count) return;
+  this->dirty_indicies.push_back({ first, std::min(count, total - first) });
+}
+
+bool BufferData::is_dirty() const {
+  return !this->dirty_verticies.empty() || !this->dirty_indicies.empty();
+}
+
+/**
+ * Sorts & merges overlapping or nearby ranges, then uploads each merged range.
+ *  Ranges separated by less than a small gap are merged, trading a few extra
+ *  bytes for fewer upload calls.
+ */
+static void upload_dirty_ranges(GLuint buffer, const void *data, size_t elementSize, std::vector<DirtyRange> &ranges) {
+  constexpr size_t MERGE_GAP = 32;
+  if (ranges.empty()) return;
+
+  std::sort(ranges.begin(), ranges.end(), [](const DirtyRange &a, const DirtyRange &b) {
+    return a.first < b.first;
+  });
+
+  DirtyRange current = ranges[0];
+  for (size_t i = 1; i <= ranges.size(); i++) {
+    if (i < ranges.size() && ranges[i].first <= current.first + current.count + MERGE_GAP) {
+      current.count = std::max(current.first + current.count, ranges[i].first + ranges[i].count) - current.first;
+      continue;
+    }
+
+    glNamedBufferSubData(
+      buffer,
+      current.first * elementSize,
+      current.count * elementSize,
+      (const GLubyte*)data + current.first * elementSize
+    );
+    GLState::countUpload(current.count * elementSize);
+
+    if (i < ranges.size()) current = ranges[i];
+  }
+
+  ranges.clear();
+}
+
 void BufferData::update() {
-  glNamedBufferSubData(
-    this->verticiesBuffer,
-    0,
-    this->vertex_buffer_size_bytes,
-    this->vertex_buffer_ptr
-  );
+  upload_dirty_ranges(this->verticiesBuffer, this->vertex_buffer_ptr, sizeof(Vertex), this->dirty_verticies);
+  upload_dirty_ranges(this->indiciesBuffer, this->index_buffer_ptr, sizeof(GLuint), this->dirty_indicies);
+}
+
+void BufferData::set_data(const Vertex *verticies, size_t vSize, const GLuint *indicies, size_t iSize) {
+  if (this->vertex_buffer_size_bytes != (GLsizei)vSize) {
+    delete[] this->vertex_buffer_ptr;
+    this->vertex_buffer_ptr = new Vertex[vSize / sizeof(Vertex)];
+    this->vertex_buffer_size_bytes = vSize;
+  }
+  memcpy(this->vertex_buffer_ptr, verticies, vSize);
+
+  if (this->index_buffer_size_bytes != (GLsizei)iSize) {
+    delete[] this->index_buffer_ptr;
+    this->index_buffer_ptr = new GLuint[iSize / sizeof(GLuint)];
+    this->index_buffer_size_bytes = iSize;
+  }
+  memcpy(this->index_buffer_ptr, indicies, iSize);
+  this->indiciesElts = iSize / sizeof(GLuint);
+  if (!this->has_gpu_store()) return;
+
+  // Whole stores are respecified, pending ranges are stale.
+  glNamedBufferData(this->verticiesBuffer, vSize, verticies, this->usage);
+  glNamedBufferData(this->indiciesBuffer, iSize, indicies, GL_STATIC_DRAW);
+  GLState::countUpload(vSize + iSize);
+  this->dirty_verticies.clear();
+  this->dirty_indicies.clear();
+}
+
+size_t BufferData::vertex_count() const {
+  return this->vertex_buffer_size_bytes / sizeof(Vertex);
+}
 
-  glNamedBufferSubData(
-    this->indiciesBuffer,
-    0,
-    this->index_buffer_size_bytes,
-    this->index_buffer_ptr
-  );
+bool BufferData::has_gpu_store() const {
+  return this->verticiesBuffer != 0;
+}
+
+
+/* Copies the data into the Buffer, read when drawn through the BatchRenderer */
+static void copy_local(BufferData &data, const Vertex *dataPack, size_t vSize, const GLuint *indicies, size_t iSize) {
+  data.vertex_buffer_size_bytes = vSize;
+  data.vertex_buffer_ptr        = new Vertex[data.vertex_buffer_size_bytes / sizeof(Vertex)];
+  memcpy(data.vertex_buffer_ptr, dataPack, data.vertex_buffer_size_bytes);
+
+  data.index_buffer_size_bytes  = iSize;
+  data.index_buffer_ptr         = new GLuint[data.index_buffer_size_bytes / sizeof(GLuint)];
+  memcpy(data.index_buffer_ptr, indicies, data.index_buffer_size_bytes);
 }
 
 
@@ -72,19 +207,18 @@ void BufferData::update() {
  * Data is configured and packaged in an Object with the
  *  reference IDs given by OpenGL and returned.
  *
- * Data is packed in an array of:
- *   [ VERTEX<vec3>   RGBA<vec4>    Texture Coordinates<vec2> ]
+ * Data is packed in an array of Vertex:
+ *   [ VERTEX<vec3 float>   RGBA<4 x ubyte>    Texture Coordinates<vec2 float> ]
  *
  * @param dataPack - Data Pack for Buffer
  * @param vSize   - Size of the array in Bytes (sizeof(verticies))
  * @param indicies - The Indicies Array, specifying the order of Vertex to be drawn
  * @param iSize   - Size of the array in Bytes (sizeof(indicies))
  * @param programID - Program ID of Compiled Shaders
+ * @param layout  - Describes how the vertex data is interpreted
  * @return BufferData Object with the Object Reference IDs stored
  */
-inline BufferData CreateBuffer::float_buffer(GLdouble* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader, GLenum buffer_usage) {
-  GLsizei vertexStride = 9;
-
+inline BufferData CreateBuffer::float_buffer(Vertex* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader, GLenum buffer_usage, const VertexLayout &layout) {
   /* 0. Allocate Verticies Buffer Object on GPU */
   GLuint VAO;                  // Vertex Array Object (Binds Vertex Buffer with the Attributes Specified)
   GLuint vBuffer;              // Vertex Buffer
@@ -95,12 +229,12 @@ inline BufferData CreateBuffer::float_buffer(GLdouble* dataPack, size_t vSize, G
 
 
   /* 0.5. Bind the VAO so that the data is stored in it */
-  glBindVertexArray(VAO);
+  GLState::bindVertexArray(VAO);
 
 
   /* 1. Specify how to Interpret the Vertex Data (Buffer Attribute) */
   // Bind Vertex Buffer Data
-  glBindBuffer(GL_ARRAY_BUFFER, vBuffer);  // Tell OpenGL it's an Array Buffer
+  GLState::bindBuffer(GL_ARRAY_BUFFER, vBuffer);  // Tell OpenGL it's an Array Buffer
 
   /* Send the data into the Buffer Memory to Binded Buffer
    * Docs: https://docs.gl/gl4/glBufferData
@@ -109,62 +243,51 @@ inline BufferData CreateBuffer::float_buffer(GLdouble* dataPack, size_t vSize, G
 	 *  GL_STREAM_DRAW:   the data will change every time it is drawn.
 	 */
   glBufferData(GL_ARRAY_BUFFER, vSize, dataPack, buffer_usage);
-  glEnableVertexAttribArray(0);  // Enable aPos Attribute
-  glVertexAttribPointer(
-    0,                                  // Which Index Attribute to Configure (At Location 0, aPos)
-    3,                                  // There are Values per Vertex (x,y,z)
-    GL_DOUBLE,                           // Type of Data in the Array
-    GL_FALSE,                           // Normalize?
-    vertexStride * sizeof(GLdouble),    // Stride till next Vertex
-    (void*)0                            // Pointer to the Beginning position in the Buffer
-  );
 
 
-  /* 2. Store Index Elements Data */
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iBuffer);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, iSize, indicies, buffer_usage);
-  glDisableVertexAttribArray(0);  // Disable aPos Attribute
+  /* 2. Store Index Elements Data, only modified on topology changes */
+  GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, iBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, iSize, indicies, GL_STATIC_DRAW);
+  GLState::countUpload(vSize + iSize);
 
 
-  /* 3. Configure RGB Attribute */
-  GLuint aRGBA = glGetAttribLocation(shader->ID, "aRGBA");
-  glEnableVertexAttribArray(aRGBA);
-  glVertexAttribPointer(aRGBA, 4, GL_DOUBLE, GL_FALSE, 9 * sizeof(GLdouble), (void*)(3 * sizeof(GLdouble)));
+  /* 3. Configure Position, RGBA & Texture Coordinates Attributes */
+  layout.apply(shader->ID);
 
-  /* 4. Configure Texture Coordinates Attribute */
-  GLuint aTextCoord = glGetAttribLocation(shader->ID, "aTextCoord");
-  glEnableVertexAttribArray(aTextCoord);
-  glVertexAttribPointer(aTextCoord, 2, GL_DOUBLE, GL_FALSE, 9 * sizeof(GLdouble), (void*)(7 * sizeof(GLdouble)));
 
-
-  /* 5. Object is ready to be Drawn */
+  /* 4. Object is ready to be Drawn */
   BufferData data(vBuffer, iBuffer, VAO);             // Create data Reference Object
   data.indiciesElts = iSize / sizeof(indicies[0]);    // Store Number of Indicies
-  data.stride = vertexStride;
+  data.stride = layout.stride;
+  data.usage = buffer_usage;
 
   // Keep track of the applied shader so that it doesn't get deallocated while in use.
   data.shader = shader;
 
   // Store a copy of the data.
-  data.vertex_buffer_size_bytes = vSize;
-  data.vertex_buffer_ptr        = new GLdouble[data.vertex_buffer_size_bytes / sizeof(GLdouble)];
-  memcpy(data.vertex_buffer_ptr, dataPack, data.vertex_buffer_size_bytes);
-
-  data.index_buffer_size_bytes  = iSize;
-  data.index_buffer_ptr         = new GLuint[data.index_buffer_size_bytes / sizeof(GLuint)];
-  memcpy(data.index_buffer_ptr, indicies, data.index_buffer_size_bytes);
-
+  copy_local(data, dataPack, vSize, indicies, iSize);
   return data;
 }
 
-BufferData CreateBuffer::static_float(GLdouble* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader) {
-  return float_buffer(dataPack, vSize, indicies, iSize, shader, GL_STATIC_DRAW);
+BufferData CreateBuffer::static_float(Vertex* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader, const VertexLayout &layout) {
+  return float_buffer(dataPack, vSize, indicies, iSize, shader, GL_STATIC_DRAW, layout);
+}
+
+BufferData CreateBuffer::stream_float(Vertex* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader, const VertexLayout &layout) {
+  return float_buffer(dataPack, vSize, indicies, iSize, shader, GL_STREAM_DRAW, layout);
 }
 
-BufferData CreateBuffer::stream_float(GLdouble* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader) {
-  return float_buffer(dataPack, vSize, indicies, iSize, shader, GL_STREAM_DRAW);
+BufferData CreateBuffer::dynamic_float(Vertex* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader, const VertexLayout &layout) {
+  return float_buffer(dataPack, vSize, indicies, iSize, shader, GL_DYNAMIC_DRAW, layout);
 }
 
-BufferData CreateBuffer::dynamic_float(GLdouble* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader) {
-  return float_buffer(dataPack, vSize, indicies, iSize, shader, GL_DYNAMIC_DRAW);
+BufferData CreateBuffer::local_float(Vertex* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader) {
+  BufferData data;
+  data.indiciesElts = iSize / sizeof(indicies[0]);
+  data.stride = sizeof(Vertex);
+  data.usage = GL_DYNAMIC_DRAW;
+  data.shader = shader;
+
+  copy_local(data, dataPack, vSize, indicies, iSize);
+  return data;
 }
\ No newline at end of file
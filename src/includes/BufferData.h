@@ -7,6 +7,66 @@
 // Core libraries
 #include <GL/glew.h>
 #include <memory>
+#include <vector>
+
+
+/**
+ * Packed vertex format used by all shapes. (24 bytes)
+ *   [ VERTEX<vec3 float>   RGBA<4 x ubyte, normalized>   Texture Coordinates<vec2 float> ]
+ */
+struct Vertex {
+  GLfloat x, y, z;      // Position
+  GLubyte r, g, b, a;   // Color (0-255), normalized to [0,1] in the shader
+  GLfloat u, v;         // Texture Coordinates
+
+  Vertex() = default;
+  Vertex(double x, double y, double z, GLubyte r, GLubyte g, GLubyte b, GLubyte a, double u, double v)
+    : x(x), y(y), z(z), r(r), g(g), b(b), a(a), u(u), v(v) {}
+};
+static_assert(sizeof(Vertex) == 24, "Vertex must be tightly packed");
+
+
+/* Single attribute within a Vertex Layout */
+struct VertexAttribute {
+  const char *name;       // Name of the attribute in the shader
+  GLint location;         // Fixed attribute location, or -1 to query it by name
+  GLint size;             // Number of components
+  GLenum type;            // Component type (GL_FLOAT, GL_UNSIGNED_BYTE, ...)
+  GLboolean normalized;   // Normalize integer components into [0,1]
+  GLsizei offset;         // Offset in bytes from the start of the vertex
+};
+
+/* Range of elements [first, first + count) that needs uploading */
+struct DirtyRange {
+  size_t first;
+  size_t count;
+};
+
+/**
+ * Describes how the vertex buffer data is interpreted by
+ *  the vertex shader.
+ */
+class VertexLayout {
+  public:
+    GLsizei stride;                           // Stride in bytes to the next vertex.
+    std::vector<VertexAttribute> attributes;  // Attributes within a single vertex.
+
+  public:
+    VertexLayout(GLsizei stride);
+
+    /* Appends an attribute to the layout. Returns itself for chaining. */
+    VertexLayout& add(const char *name, GLint location, GLint size, GLenum type, GLboolean normalized, GLsizei offset);
+
+    /**
+     * Configures the attribute pointers on the currently bound VAO & Vertex Buffer.
+     *  Attributes that are not active in the shader program are skipped.
+     *	@param programID - Program used to resolve attribute locations by name
+     */
+    void apply(GLuint programID) const;
+
+    /* Layout matching the packed Vertex structure */
+    static VertexLayout packed();
+};
 
 /**
  * Stores Data Objects of the There
@@ -21,20 +81,25 @@
  */
 class BufferData {
   public:
-    GLsizei stride;           // Stride to next vertex.
+    GLsizei stride;           // Stride in bytes to next vertex.
 
-    GLdouble *vertex_buffer_ptr;        // Copy of the vertex buffer data.
+    Vertex *vertex_buffer_ptr;          // Copy of the vertex buffer data.
     GLsizei vertex_buffer_size_bytes;   // Size of the vertex buffer data.
 
     GLuint *index_buffer_ptr;           // Copy of the index buffer data.
     GLsizei index_buffer_size_bytes;    // Size of the index buffer data.
 
+  private:
+    std::vector<DirtyRange> dirty_verticies;  // Modified verticies, not yet uploaded.
+    std::vector<DirtyRange> dirty_indicies;   // Modified indicies, not yet uploaded.
+
   public:                     // Public Variables
     GLuint VAO;               // Vertex Array Object
     GLuint verticiesBuffer;   // Vertex Buffer
     GLuint indiciesBuffer;    // Index Buffer
-    Texture *texture;         // Texture Object
+    std::shared_ptr<Texture> texture;  // Texture Object, shared through the TextureCache
     size_t indiciesElts = 0;  // Number of Indicies
+    GLenum usage;             // Usage hint of the Vertex Buffer
 
     // Shared pointer to a shader since there could be multiple references.
     // Bound shader program on this buffer.
@@ -53,23 +118,68 @@ class BufferData {
     */
     BufferData(GLuint&, GLuint&, GLuint&);
 
-    /* Updates the buffer data store with the current instance's data */
+    /**
+     * Marks a range of verticies as modified, to be uploaded on the next update.
+     *	@param first - Index of the first modified vertex
+     *	@param count - Number of modified verticies
+     */
+    void mark_verticies_dirty(size_t first, size_t count);
+
+    /**
+     * Marks a range of indicies as modified, to be uploaded on the next update.
+     *  The index buffer is otherwise immutable, only needed on topology changes.
+     *	@param first - Index of the first modified index
+     *	@param count - Number of modified indicies
+     */
+    void mark_indicies_dirty(size_t first, size_t count);
+
+    /* Returns whether there are modifications not yet uploaded */
+    bool is_dirty() const;
+
+    /**
+     * Updates the buffer data store with the modified ranges of the
+     *  current instance's data. Nothing is uploaded if unmodified, or
+     *  without a buffer data store (see CreateBuffer::local_float).
+     */
     void update();
 
+    /**
+     * Replaces the stored geometry, reallocating both the local copy and the
+     *  buffer data store, if any. Used on topology changes of a different size.
+     *	@param verticies - Verticies Array
+     *	@param vSize - Size of the verticies array in Bytes
+     *	@param indicies - Indicies Array
+     *	@param iSize - Size of the indicies array in Bytes
+     */
+    void set_data(const Vertex *verticies, size_t vSize, const GLuint *indicies, size_t iSize);
+
+    /* Returns the number of verticies stored in the vertex buffer */
+    size_t vertex_count() const;
+
+    /* Returns whether the data is stored on the GPU, not only in the local copy */
+    bool has_gpu_store() const;
+
     /* Method that frees up used Memory */
     static void freeBufferData(BufferData*);
 };
 
 namespace CreateBuffer {
   /* Creates a float Buffer with a given buffer usage (https://docs.gl/gl4/glBufferData) */
-  inline BufferData float_buffer(GLdouble* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader, GLenum buffer_usage);
+  inline BufferData float_buffer(Vertex* dataPack, size_t vSize, GLuint* indicies, size_t iSize, std::shared_ptr<Shader> shader, GLenum buffer_usage, const VertexLayout &layout);
 
   /* Creates a Static Draw float Buffer */
-	BufferData static_float(GLdouble *dataPack, size_t vSize, GLuint *indicies, size_t iSize, std::shared_ptr<Shader> shader);
+	BufferData static_float(Vertex *dataPack, size_t vSize, GLuint *indicies, size_t iSize, std::shared_ptr<Shader> shader, const VertexLayout &layout = VertexLayout::packed());
 
   /* Creates a Stream Draw float Buffer */
-	BufferData stream_float(GLdouble *dataPack, size_t vSize, GLuint *indicies, size_t iSize, std::shared_ptr<Shader> shader);
+	BufferData stream_float(Vertex *dataPack, size_t vSize, GLuint *indicies, size_t iSize, std::shared_ptr<Shader> shader, const VertexLayout &layout = VertexLayout::packed());
 
   /* Creates a Dynamnic Draw float Buffer */
-	BufferData dynamic_float(GLdouble *dataPack, size_t vSize, GLuint *indicies, size_t iSize, std::shared_ptr<Shader> shader);
+	BufferData dynamic_float(Vertex *dataPack, size_t vSize, GLuint *indicies, size_t iSize, std::shared_ptr<Shader> shader, const VertexLayout &layout = VertexLayout::packed());
+
+  /**
+   * Creates a Buffer holding only the local copy, without GL Objects. For
+   *  geometry streamed by the BatchRenderer, which reads the local copy, so
+   *  edits are never uploaded to a store nothing draws from.
+   */
+	BufferData local_float(Vertex *dataPack, size_t vSize, GLuint *indicies, size_t iSize, std::shared_ptr<Shader> shader);
 };
\ No newline at end of file
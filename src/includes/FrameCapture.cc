@@ -0,0 +1,348 @@
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image/stb_image_write.h>
+#include "FrameCapture.h"
+#include "GLState.h"
+
+#include <spdlog/spdlog.h>
+
+
+/*
+ ***************************************************************
+ * Constructors & GL Resources
+ *	- Constructor
+ *		- Configures the number of slots
+ *	- Initialize & Destroy the buffers & worker thread
+ ***************************************************************
+ */
+FrameCapture::FrameCapture(size_t slots) :
+  slots(new Slot[slots]),
+  slotCount(slots),
+  recording(false),
+  recordingStopping(false),
+  recordWidth(0),
+  recordHeight(0),
+  running(false),
+  videoFps(0),
+  videoWidth(0),
+  videoHeight(0),
+  videoFrames(0),
+  dropped(0),
+  captured(0) {}
+
+FrameCapture::~FrameCapture() {
+  // GL Objects are released on destroy(), the worker must not outlive the object.
+  if (this->worker.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->running = false;
+    }
+    this->wakeup.notify_one();
+    this->worker.join();
+  }
+}
+
+void FrameCapture::init() {
+  for (size_t i = 0; i < this->slotCount; i++)
+    glCreateBuffers(1, &this->slots[i].pbo);
+
+  this->running = true;
+  this->worker = std::thread(&FrameCapture::work, this);
+}
+
+void FrameCapture::destroy() {
+  if (!this->worker.joinable()) return;
+
+  // Hand over the frames still being read back.
+  if (this->recording) this->stopRecording();
+  this->flush();
+
+  // Worker drains the queue prior to exiting.
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->running = false;
+  }
+  this->wakeup.notify_one();
+  this->worker.join();
+
+  for (size_t i = 0; i < this->slotCount; i++) {
+    Slot &slot = this->slots[i];
+    if (slot.state != SlotState::Idle) glUnmapNamedBuffer(slot.pbo);
+    slot.state = SlotState::Idle;
+    GLState::deleteBuffer(slot.pbo);
+  }
+}
+
+
+/*
+ ***************************************************************
+ * Capture Requests
+ ***************************************************************
+ */
+void FrameCapture::screenshot(const std::string &path) {
+  this->screenshotPath = path;
+}
+
+void FrameCapture::startRecording(const std::string &path, unsigned int fps) {
+  // Finish the current recording, its last frames must land in its own stream.
+  if (this->recording || this->recordingStopping) {
+    this->stopRecording();
+    this->flush();
+  }
+
+  this->recording = true;
+  this->recordWidth = this->recordHeight = 0;
+  this->enqueue({ JobType::RecordStart, nullptr, nullptr, 0, 0, path, fps });
+}
+
+void FrameCapture::stopRecording() {
+  if (!this->recording) return;
+  this->recording = false;
+  this->recordingStopping = true;
+}
+
+bool FrameCapture::isRecording() const {
+  return this->recording;
+}
+
+
+/*
+ ***************************************************************
+ * Render Thread
+ *	- Unmap slots the worker is done with
+ *	- Hand signaled read backs to the worker, in order
+ *	- Start reading the current frame into a free slot
+ ***************************************************************
+ */
+void FrameCapture::collect() {
+  for (size_t i = 0; i < this->slotCount; i++) {
+    Slot &slot = this->slots[i];
+    if (slot.state == SlotState::Encoded) {
+      glUnmapNamedBuffer(slot.pbo);
+      slot.state = SlotState::Idle;
+    }
+  }
+
+  // Frames are handed over in submission order, to keep the video ordered.
+  while (!this->pending.empty()) {
+    Slot *slot = this->pending.front();
+    const GLenum status = glClientWaitSync(slot->fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+    glDeleteSync(slot->fence);
+    slot->fence = nullptr;
+    this->pending.pop_front();
+
+    const size_t size = (size_t)slot->width * slot->height * 4;
+    const GLubyte *pixels = (const GLubyte*)glMapNamedBufferRange(slot->pbo, 0, size, GL_MAP_READ_BIT);
+    if (!pixels) {
+      spdlog::error("FrameCapture: Failed to map pixel pack buffer");
+      slot->state = SlotState::Idle;
+      this->dropped++;
+      continue;
+    }
+
+    slot->state = SlotState::Encoding;
+    this->enqueue({ slot->type, slot, pixels, slot->width, slot->height, slot->path, 0 });
+  }
+
+  // Close the video once its last frame is queued.
+  if (this->recordingStopping) {
+    bool framesPending = false;
+    for (const Slot *slot : this->pending)
+      framesPending |= slot->type == JobType::RecordFrame;
+
+    if (!framesPending) {
+      this->recordingStopping = false;
+      this->enqueue({ JobType::RecordStop, nullptr, nullptr, 0, 0, "", 0 });
+    }
+  }
+}
+
+void FrameCapture::flush() {
+  for (Slot *slot : this->pending)
+    glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+  this->collect();
+}
+
+void FrameCapture::capture(GLuint framebuffer, GLsizei width, GLsizei height) {
+  if (!this->worker.joinable()) return;
+  this->collect();
+
+  // A Y4M stream has a single frame size, end the recording on resize.
+  if (this->recording) {
+    if (this->recordWidth == 0) {
+      this->recordWidth = width;
+      this->recordHeight = height;
+    } else if (width != this->recordWidth || height != this->recordHeight) {
+      spdlog::warn("FrameCapture: Frame size changed from {}x{} to {}x{}, stopping the recording",
+        this->recordWidth, this->recordHeight, width, height);
+      this->stopRecording();
+    }
+  }
+
+  const bool wantsScreenshot = !this->screenshotPath.empty();
+  if (!wantsScreenshot && !this->recording) return;
+
+  // Find a free slot, never waiting on one.
+  Slot *slot = nullptr;
+  for (size_t i = 0; i < this->slotCount && !slot; i++)
+    if (this->slots[i].state == SlotState::Idle) slot = &this->slots[i];
+
+  if (!slot) {
+    // Screenshots are retried on the next frame.
+    if (this->recording) this->dropped++;
+    return;
+  }
+
+  // Grow the buffer store if the frame got larger.
+  const size_t size = (size_t)width * height * 4;
+  if (slot->capacity < size) {
+    glNamedBufferData(slot->pbo, size, nullptr, GL_STREAM_READ);
+    slot->capacity = size;
+  }
+
+  // A screenshot taken while recording shares the frame, so the video has no hole.
+  slot->width = width;
+  slot->height = height;
+  slot->type = this->recording ? JobType::RecordFrame : JobType::Screenshot;
+  slot->path = this->screenshotPath;
+  this->screenshotPath.clear();
+
+  // Read into the pixel pack buffer, returns without waiting on the GPU.
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot->state = SlotState::Reading;
+  this->pending.push_back(slot);
+}
+
+
+/*
+ ***************************************************************
+ * Worker Thread
+ *	- Encodes PNG screenshots & Y4M video frames
+ ***************************************************************
+ */
+void FrameCapture::enqueue(Job &&job) {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->jobs.push_back(std::move(job));
+  }
+  this->wakeup.notify_one();
+}
+
+void FrameCapture::work() {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true) {
+    this->wakeup.wait(lock, [this] { return !this->jobs.empty() || !this->running; });
+    if (this->jobs.empty()) break;   // Stopped & drained.
+
+    Job job = std::move(this->jobs.front());
+    this->jobs.pop_front();
+
+    lock.unlock();
+    this->process(job);
+    if (job.slot) job.slot->state = SlotState::Encoded;
+    lock.lock();
+  }
+}
+
+void FrameCapture::writeScreenshot(const Job &job) {
+  // Rows are bottom first, write them top first through a negative stride.
+  const size_t stride = (size_t)job.width * 4;
+  const GLubyte *top = job.pixels + stride * (job.height - 1);
+  if (stbi_write_png(job.path.c_str(), job.width, job.height, 4, top, -(int)stride))
+    this->captured++;
+  else
+    spdlog::error("FrameCapture: Failed to write screenshot '{}'", job.path);
+}
+
+void FrameCapture::process(const Job &job) {
+  const size_t stride = (size_t)job.width * 4;
+
+  switch (job.type) {
+    case JobType::Screenshot:
+      this->writeScreenshot(job);
+      break;
+
+    case JobType::RecordStart:
+      // Header is written along with the first frame, once its size is known.
+      if (this->video.is_open()) this->video.close();
+      this->video.clear();
+      this->video.open(job.path, std::ios::binary);
+      this->videoFps = job.fps;
+      this->videoFrames = 0;
+      if (!this->video) spdlog::error("FrameCapture: Failed to open video '{}'", job.path);
+      break;
+
+    case JobType::RecordFrame: {
+      if (!job.path.empty()) this->writeScreenshot(job);
+      if (!this->video.is_open()) break;
+
+      const size_t pixels = (size_t)job.width * job.height;
+      if (this->videoFrames == 0) {
+        this->videoWidth = job.width;
+        this->videoHeight = job.height;
+        this->video << "YUV4MPEG2 W" << job.width << " H" << job.height
+                    << " F" << this->videoFps << ":1 Ip A1:1 C444\n";
+      }
+      else if (job.width != this->videoWidth || job.height != this->videoHeight) {
+        // Frames must match the header, the render thread stops on resize.
+        this->dropped++;
+        break;
+      }
+      this->videoFrames++;
+
+      // BT.601 limited range, full resolution chroma.
+      this->planes.resize(pixels * 3);
+      GLubyte *Y = this->planes.data();
+      GLubyte *U = Y + pixels;
+      GLubyte *V = U + pixels;
+
+      for (GLsizei row = 0; row < job.height; row++) {
+        const GLubyte *src = job.pixels + stride * (job.height - 1 - row);
+        for (GLsizei x = 0; x < job.width; x++, src += 4) {
+          const int r = src[0], g = src[1], b = src[2];
+          *Y++ = (GLubyte)((( 66 * r + 129 * g +  25 * b + 128) >> 8) + 16);
+          *U++ = (GLubyte)(((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128);
+          *V++ = (GLubyte)(((112 * r -  94 * g -  18 * b + 128) >> 8) + 128);
+        }
+      }
+
+      this->video << "FRAME\n";
+      this->video.write((const char*)this->planes.data(), this->planes.size());
+      this->captured++;
+      break;
+    }
+
+    case JobType::RecordStop:
+      this->video.close();
+      break;
+  }
+}
+
+
+/*
+ ***************************************************************
+ * Statistics
+ ***************************************************************
+ */
+size_t FrameCapture::getInFlight() const {
+  size_t count = 0;
+  for (size_t i = 0; i < this->slotCount; i++)
+    count += this->slots[i].state != SlotState::Idle;
+  return count;
+}
+
+size_t FrameCapture::getDropped() const {
+  return this->dropped;
+}
+
+size_t FrameCapture::getCaptured() const {
+  return this->captured;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+// Core libraries
+#include <GL/glew.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/* Default number of frames that can be read back at once */
+#define FRAME_CAPTURE_SLOTS 3
+
+
+/**
+ * Captures rendered frames without stalling the render thread.
+ *  - Frames are read into a ring of pixel pack buffers, fenced
+ *  - Once the GPU is done, the mapped pixels are handed to a worker thread
+ *  which encodes PNG screenshots or a raw Y4M video stream
+ *  - When every slot is busy, the frame is dropped instead of waiting
+ */
+class FrameCapture {
+  private:
+    /* Lifetime of a slot: read on the GPU, encoded on the worker, then unmapped */
+    enum class SlotState { Idle, Reading, Encoding, Encoded };
+
+    enum class JobType { Screenshot, RecordStart, RecordFrame, RecordStop };
+
+    struct Slot {
+      GLuint pbo = 0;                     // Pixel Pack Buffer
+      GLsync fence = nullptr;             // Signaled once the read back landed
+      GLsizei width = 0, height = 0;
+      size_t capacity = 0;                // Size of the buffer store in bytes
+      JobType type = JobType::Screenshot; // What the frame is captured for
+      std::string path;                   // Screenshot output path, may come along with a recorded frame
+      std::atomic<SlotState> state { SlotState::Idle };
+    };
+
+    struct Job {
+      JobType type;
+      Slot *slot;                         // nullptr for control jobs
+      const GLubyte *pixels;              // Mapped pixels, bottom row first
+      GLsizei width, height;
+      std::string path;
+      unsigned int fps;
+    };
+
+  private:  // Render thread state
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount;
+    std::deque<Slot*> pending;            // Slots being read back, in submission order
+    std::string screenshotPath;           // Requested screenshot, empty if none
+    bool recording;
+    bool recordingStopping;               // Stop once pending frames are handed over
+    GLsizei recordWidth, recordHeight;    // Size of the recorded frames, 0 until the first one
+
+  private:  // Worker thread state
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<Job> jobs;
+    bool running;
+    std::ofstream video;                  // Y4M stream being recorded
+    unsigned int videoFps;
+    GLsizei videoWidth, videoHeight;      // Size written in the stream header
+    size_t videoFrames;                   // Frames written to the stream
+    std::vector<GLubyte> planes;          // Y, U & V planes of a frame
+
+  private:  // Statistics
+    std::atomic<size_t> dropped;
+    std::atomic<size_t> captured;
+
+  private:
+    /* Unmaps encoded slots & hands finished read backs to the worker */
+    void collect();
+
+    /* Waits on every read back in flight & hands them to the worker */
+    void flush();
+
+    /* Writes a screenshot, on the worker thread */
+    void writeScreenshot(const Job &job);
+
+    /* Queues a job for the worker thread */
+    void enqueue(Job &&job);
+
+    /* Worker thread loop */
+    void work();
+
+    /* Encodes a single job, on the worker thread */
+    void process(const Job &job);
+
+  public:
+    /**
+     * Constructs the capture ring. GL Objects are created on init().
+     *	@param slots - Number of frames that can be read back at once
+     */
+    FrameCapture(size_t slots = FRAME_CAPTURE_SLOTS);
+    ~FrameCapture();
+
+    /* Creates the pixel pack buffers & starts the worker. Requires a current GL Context */
+    void init();
+
+    /* Finishes pending captures, stops the worker & releases the GL Objects */
+    void destroy();
+
+    /**
+     * Requests a PNG screenshot of the next captured frame.
+     *	@param path - Output file path
+     */
+    void screenshot(const std::string &path);
+
+    /**
+     * Starts recording every frame into a Y4M (4:4:4) video stream. A
+     *  recording in progress is finished first. Recording stops if the
+     *  frame size changes, the stream has a single size.
+     *	@param path - Output file path
+     *	@param fps - Frame rate written in the stream header
+     */
+    void startRecording(const std::string &path, unsigned int fps);
+
+    /* Stops recording, once the frames in flight are written */
+    void stopRecording();
+
+    /* Returns whether frames are being recorded */
+    bool isRecording() const;
+
+    /**
+     * Called once per frame after drawing. Starts reading back the frame
+     *  if requested, never waiting on the GPU or the worker.
+     *	@param framebuffer - Framebuffer to read from, 0 for the window's back buffer
+     *	@param width - Width of the frame
+     *	@param height - Height of the frame
+     */
+    void capture(GLuint framebuffer, GLsizei width, GLsizei height);
+
+    /* Returns the number of frames being read back or encoded */
+    size_t getInFlight() const;
+
+    /* Returns the number of frames dropped since every slot was busy */
+    size_t getDropped() const;
+
+    /* Returns the number of frames written out */
+    size_t getCaptured() const;
+};
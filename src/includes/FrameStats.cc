@@ -0,0 +1,135 @@
+#include "FrameStats.h"
+
+#include <imgui/imgui.h>
+#include <algorithm>
+#include <vector>
+
+static_assert((FRAME_STATS_CAPACITY & (FRAME_STATS_CAPACITY - 1)) == 0, "FRAME_STATS_CAPACITY must be a power of two");
+static_assert(FRAME_STATS_WINDOW < FRAME_STATS_CAPACITY, "FRAME_STATS_WINDOW must fit in the ring");
+
+
+FrameStats::FrameStats() :
+  head(0),
+  hitches(0),
+  hitchLimit(0.f) {
+  for (Slot &slot : this->ring) {
+    slot.frame.store(0.f, std::memory_order_relaxed);
+    slot.cpu.store(0.f, std::memory_order_relaxed);
+    slot.gpu.store(0.f, std::memory_order_relaxed);
+  }
+}
+
+
+/*
+ ***************************************************************
+ * Recording
+ *	- Single writer: the slot is filled, then published by the
+ *	release store of the head
+ *	- Readers only copy the last FRAME_STATS_WINDOW samples, far
+ *	behind the slots being overwritten
+ ***************************************************************
+ */
+void FrameStats::record(const FrameSample &sample) {
+  const uint64_t index = this->head.load(std::memory_order_relaxed);
+  Slot &slot = this->ring[index & (FRAME_STATS_CAPACITY - 1)];
+  slot.frame.store(sample.frame, std::memory_order_relaxed);
+  slot.cpu.store(sample.cpu, std::memory_order_relaxed);
+  slot.gpu.store(sample.gpu, std::memory_order_relaxed);
+  this->head.store(index + 1, std::memory_order_release);
+
+  const float limit = this->hitchLimit.load(std::memory_order_relaxed);
+  if (limit > 0.f && sample.frame > limit)
+    this->hitches.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t FrameStats::snapshot(FrameSample *samples, size_t count) const {
+  const uint64_t end = this->head.load(std::memory_order_acquire);
+  count = std::min<uint64_t>({ count, FRAME_STATS_WINDOW, end });
+
+  for (size_t i = 0; i < count; i++) {
+    const Slot &slot = this->ring[(end - count + i) & (FRAME_STATS_CAPACITY - 1)];
+    samples[i] = {
+      slot.frame.load(std::memory_order_relaxed),
+      slot.cpu.load(std::memory_order_relaxed),
+      slot.gpu.load(std::memory_order_relaxed)
+    };
+  }
+  return count;
+}
+
+
+/*
+ ***************************************************************
+ * Statistics
+ *	- Nearest-rank percentiles of the frame times in the window
+ ***************************************************************
+ */
+FrameSummary FrameStats::compute() const {
+  FrameSample samples[FRAME_STATS_WINDOW];
+  const size_t count = this->snapshot(samples, FRAME_STATS_WINDOW);
+
+  FrameSummary result;
+  if (count == 0) return result;
+
+  std::vector<float> times(count);
+  size_t gpuFrames = 0;
+  for (size_t i = 0; i < count; i++) {
+    times[i] = samples[i].frame;
+    result.mean += samples[i].frame;
+    result.cpuMean += samples[i].cpu;
+    if (samples[i].gpu > 0.f) {
+      result.gpuMean += samples[i].gpu;
+      gpuFrames++;
+    }
+  }
+  result.frames = count;
+  result.mean /= count;
+  result.cpuMean /= count;
+  result.gpuMean = gpuFrames ? result.gpuMean / gpuFrames : 0.0;
+  result.fps = result.mean > 0.0 ? 1000.0 / result.mean : 0.0;
+
+  std::sort(times.begin(), times.end());
+  auto percentile = [&](double p) {
+    const size_t rank = (size_t)(p * count + 0.999999);
+    return (double)times[std::min(std::max<size_t>(rank, 1), count) - 1];
+  };
+  result.p50 = percentile(0.50);
+  result.p95 = percentile(0.95);
+  result.p99 = percentile(0.99);
+  result.max = times.back();
+
+  const double limit = result.p50 * FRAME_STATS_HITCH_FACTOR;
+  result.hitches = times.end() - std::upper_bound(times.begin(), times.end(), (float)limit);
+  return result;
+}
+
+const FrameSummary& FrameStats::update() {
+  this->summary = this->compute();
+  this->hitchLimit.store(this->summary.p50 * FRAME_STATS_HITCH_FACTOR, std::memory_order_relaxed);
+  return this->summary;
+}
+
+const FrameSummary& FrameStats::getSummary() const {
+  return this->summary;
+}
+
+uint64_t FrameStats::getTotalHitches() const {
+  return this->hitches.load(std::memory_order_relaxed);
+}
+
+void FrameStats::drawImGui() const {
+  FrameSample samples[FRAME_STATS_WINDOW];
+  const size_t count = this->snapshot(samples, FRAME_STATS_WINDOW);
+
+  float times[FRAME_STATS_WINDOW];
+  for (size_t i = 0; i < count; i++) times[i] = samples[i].frame;
+
+  // Scale to the slowest frames, at least a 30 FPS frame.
+  const FrameSummary &s = this->summary;
+  const float scale = std::max(33.3f, (float)s.max * 1.1f);
+  ImGui::PlotHistogram("##frametimes", times, count, 0, "Frame Time (ms)", 0.f, scale, ImVec2(0, 60));
+
+  ImGui::Text("Mean %.2f ms (%.1f FPS) | CPU %.2f ms | GPU %.2f ms", s.mean, s.fps, s.cpuMean, s.gpuMean);
+  ImGui::Text("p50 %.2f | p95 %.2f | p99 %.2f | max %.2f ms", s.p50, s.p95, s.p99, s.max);
+  ImGui::Text("Hitches: %zu in window | %llu total", s.hitches, (unsigned long long)this->getTotalHitches());
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+// Core libraries
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Frames kept in the ring, a power of two */
+#define FRAME_STATS_CAPACITY 1024
+
+/* Most recent frames the statistics are computed over */
+#define FRAME_STATS_WINDOW 240
+
+/* Frames taking longer than this many times the median are hitches */
+#define FRAME_STATS_HITCH_FACTOR 2.0
+
+/* Seconds between summaries (& window title updates) */
+#define FRAME_STATS_INTERVAL 0.5
+
+
+/* Times of a frame, in milliseconds */
+struct FrameSample {
+  float frame;      // Time since the previous frame started
+  float cpu;        // CPU time spent recording the frame
+  float gpu;        // GPU time of the frame, 0 if not measured
+};
+
+/* Statistics of the frames in the window, in milliseconds */
+struct FrameSummary {
+  size_t frames = 0;            // Frames the statistics cover
+  double mean = 0.0;            // Rolling mean frame time
+  double p50 = 0.0, p95 = 0.0, p99 = 0.0;
+  double max = 0.0;
+  double cpuMean = 0.0;
+  double gpuMean = 0.0;
+  size_t hitches = 0;           // Frames over FRAME_STATS_HITCH_FACTOR x p50
+  double fps = 0.0;             // 1000 / mean
+};
+
+
+/**
+ * Per-frame timings & their distribution.
+ *  - Samples go into a lock-free ring, written by the render thread only
+ *  & readable from any thread, so a monitor thread can poll statistics
+ *  without stalling the frame
+ *  - Percentiles, the max & hitch counts expose the stutters a per-second
+ *  average FPS hides
+ */
+class FrameStats {
+  private:
+    /* Ring slot, atomics so readers never see torn values */
+    struct Slot {
+      std::atomic<float> frame, cpu, gpu;
+    };
+
+  private:
+    Slot ring[FRAME_STATS_CAPACITY];
+    std::atomic<uint64_t> head;       // Samples written so far
+    std::atomic<uint64_t> hitches;    // Hitches since the start
+    std::atomic<float> hitchLimit;    // Frame time of a hitch, from the last summary
+    FrameSummary summary;             // Last summary, render thread only
+
+  public:
+    FrameStats();
+
+    /**
+     * Records the times of a frame. Render thread only.
+     *	@param sample - Times of the frame
+     */
+    void record(const FrameSample &sample);
+
+    /**
+     * Copies the most recent samples, oldest first. Safe from any thread.
+     *	@param samples - Filled with up to count samples
+     *	@param count - Max number of samples, up to FRAME_STATS_WINDOW
+     *	@returns Number of samples copied
+     */
+    size_t snapshot(FrameSample *samples, size_t count) const;
+
+    /* Computes the statistics of the last FRAME_STATS_WINDOW frames. Safe from any thread */
+    FrameSummary compute() const;
+
+    /* Recomputes the stored summary, returned by getSummary() */
+    const FrameSummary& update();
+
+    /* Returns the summary stored by the last update() */
+    const FrameSummary& getSummary() const;
+
+    /* Returns the number of hitches since the start */
+    uint64_t getTotalHitches() const;
+
+    /* Draws the frame time histogram & statistics, within an ImGui window */
+    void drawImGui() const;
+};
@@ -0,0 +1,68 @@
+#include "Framebuffer.h"
+
+#include <spdlog/spdlog.h>
+
+
+Framebuffer::Framebuffer() :
+  ID(0),
+  colorBuffer(0),
+  depthBuffer(0),
+  width(0),
+  height(0) {}
+
+bool Framebuffer::init(GLsizei width, GLsizei height) {
+  this->width = width;
+  this->height = height;
+
+  glCreateRenderbuffers(1, &this->colorBuffer);
+  glNamedRenderbufferStorage(this->colorBuffer, GL_RGBA8, width, height);
+
+  glCreateRenderbuffers(1, &this->depthBuffer);
+  glNamedRenderbufferStorage(this->depthBuffer, GL_DEPTH_COMPONENT24, width, height);
+
+  glCreateFramebuffers(1, &this->ID);
+  glNamedFramebufferRenderbuffer(this->ID, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->colorBuffer);
+  glNamedFramebufferRenderbuffer(this->ID, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depthBuffer);
+
+  const GLenum status = glCheckNamedFramebufferStatus(this->ID, GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    spdlog::error("Framebuffer: Incomplete framebuffer [0x{:x}]", status);
+    return false;
+  }
+
+  return true;
+}
+
+void Framebuffer::destroy() {
+  if (this->ID) glDeleteFramebuffers(1, &this->ID);
+  if (this->colorBuffer) glDeleteRenderbuffers(1, &this->colorBuffer);
+  if (this->depthBuffer) glDeleteRenderbuffers(1, &this->depthBuffer);
+  this->ID = this->colorBuffer = this->depthBuffer = 0;
+}
+
+void Framebuffer::bind() const {
+  glBindFramebuffer(GL_FRAMEBUFFER, this->ID);
+  glViewport(0, 0, this->width, this->height);
+}
+
+void Framebuffer::read(std::vector<GLubyte> &rgba) const {
+  rgba.resize((size_t)this->width * this->height * 4);
+
+  // Rows are tightly packed.
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glNamedFramebufferReadBuffer(this->ID, GL_COLOR_ATTACHMENT0);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, this->ID);
+  glReadPixels(0, 0, this->width, this->height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+}
+
+GLuint Framebuffer::getID() const {
+  return this->ID;
+}
+
+GLsizei Framebuffer::getWidth() const {
+  return this->width;
+}
+
+GLsizei Framebuffer::getHeight() const {
+  return this->height;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// Core libraries
+#include <GL/glew.h>
+#include <vector>
+
+
+/**
+ * Offscreen render target, with an RGBA8 color & a depth attachment.
+ */
+class Framebuffer {
+  private:
+    GLuint ID;              // Framebuffer Object
+    GLuint colorBuffer;     // Color Renderbuffer
+    GLuint depthBuffer;     // Depth Renderbuffer
+    GLsizei width, height;
+
+  public:
+    Framebuffer();
+
+    /**
+     * Creates the framebuffer & its attachments. Requires a current GL Context.
+     *	@param width - Width in pixels
+     *	@param height - Height in pixels
+     *	@returns Whether the framebuffer is complete
+     */
+    bool init(GLsizei width, GLsizei height);
+
+    /* Releases the GL Objects */
+    void destroy();
+
+    /* Binds the framebuffer as the render target & sets the viewport */
+    void bind() const;
+
+    /**
+     * Reads back the color attachment, bottom row first.
+     *	@param rgba - Resized to width * height * 4 bytes
+     */
+    void read(std::vector<GLubyte> &rgba) const;
+
+    GLuint getID() const;
+    GLsizei getWidth() const;
+    GLsizei getHeight() const;
+};
@@ -0,0 +1,184 @@
+#include "GLState.h"
+
+#include <unordered_map>
+
+
+/*
+ ***************************************************************
+ * Tracked State
+ *	- Currently bound objects, by binding point
+ *	- Value of UNKNOWN forces the next bind through
+ ***************************************************************
+ */
+#define UNKNOWN ((GLuint)-1)
+#define MAX_TEXTURE_UNITS 32
+
+namespace {
+  struct State {
+    GLuint program = UNKNOWN;
+    GLuint vao = UNKNOWN;
+    GLuint activeUnit = UNKNOWN;
+    GLuint blendMode = UNKNOWN;
+    std::unordered_map<GLenum, GLuint> buffers;                 // Target -> Buffer
+    std::unordered_map<GLenum, GLuint> textures[MAX_TEXTURE_UNITS];  // Unit -> Target -> Texture
+
+    GLStateStats frame;       // Stats of the current frame
+    GLStateStats lastFrame;   // Stats of the last finished frame
+  } state;
+
+  /* Updates the tracked value, returning whether the bind should be issued */
+  inline bool track(GLuint &current, GLuint value) {
+    if (current == value) {
+      state.frame.skipped++;
+      return false;
+    }
+
+    current = value;
+    state.frame.issued++;
+    return true;
+  }
+
+  inline GLuint& lookup(std::unordered_map<GLenum, GLuint> &bindings, GLenum target) {
+    auto it = bindings.find(target);
+    if (it == bindings.end()) it = bindings.emplace(target, UNKNOWN).first;
+    return it->second;
+  }
+};
+
+
+/*
+ ***************************************************************
+ * Bindings
+ *	- Program, VAO, Buffer & Texture unit bindings
+ *	- Blend Mode
+ ***************************************************************
+ */
+void GLState::useProgram(GLuint program) {
+  if (track(state.program, program))
+    glUseProgram(program);
+}
+
+void GLState::bindVertexArray(GLuint vao) {
+  if (track(state.vao, vao)) {
+    glBindVertexArray(vao);
+
+    // Element buffer binding is stored within the VAO.
+    state.buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+  }
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer) {
+  if (track(lookup(state.buffers, target), buffer))
+    glBindBuffer(target, buffer);
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+  // Untracked units are passed through.
+  if (unit >= MAX_TEXTURE_UNITS) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(target, texture);
+    state.activeUnit = unit;
+    state.frame.issued++;
+    return;
+  }
+
+  GLuint &current = lookup(state.textures[unit], target);
+  if (current == texture) {
+    state.frame.skipped++;
+    return;
+  }
+
+  if (track(state.activeUnit, unit))
+    glActiveTexture(GL_TEXTURE0 + unit);
+
+  track(current, texture);
+  glBindTexture(target, texture);
+}
+
+
+void GLState::setBlendMode(BlendMode mode) {
+  if (!track(state.blendMode, (GLuint)mode)) return;
+
+  switch (mode) {
+    case BlendMode::Opaque:
+      glDisable(GL_BLEND);
+      glDepthMask(GL_TRUE);
+      break;
+    case BlendMode::Alpha:
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      glDepthMask(GL_FALSE);
+      break;
+    case BlendMode::Additive:
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+      glDepthMask(GL_FALSE);
+      break;
+  }
+}
+
+
+/*
+ ***************************************************************
+ * Object Deletion
+ *	- Deleted objects are unbound by OpenGL, reflect that
+ *	in the tracked state
+ ***************************************************************
+ */
+void GLState::deleteProgram(GLuint program) {
+  if (program == 0) return;
+  glDeleteProgram(program);
+  if (state.program == program) state.program = UNKNOWN;
+}
+
+void GLState::deleteVertexArray(GLuint vao) {
+  if (vao == 0) return;
+  glDeleteVertexArrays(1, &vao);
+  if (state.vao == vao) {
+    state.vao = UNKNOWN;
+    state.buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+  }
+}
+
+void GLState::deleteBuffer(GLuint buffer) {
+  if (buffer == 0) return;
+  glDeleteBuffers(1, &buffer);
+  for (auto &binding : state.buffers)
+    if (binding.second == buffer) binding.second = UNKNOWN;
+}
+
+void GLState::deleteTexture(GLuint texture) {
+  if (texture == 0) return;
+  glDeleteTextures(1, &texture);
+  for (auto &unit : state.textures)
+    for (auto &binding : unit)
+      if (binding.second == texture) binding.second = UNKNOWN;
+}
+
+
+/*
+ ***************************************************************
+ * Cache & Stats Handling
+ ***************************************************************
+ */
+void GLState::invalidate() {
+  state.program = UNKNOWN;
+  state.vao = UNKNOWN;
+  state.activeUnit = UNKNOWN;
+  state.blendMode = UNKNOWN;
+  state.buffers.clear();
+  for (auto &unit : state.textures) unit.clear();
+}
+
+void GLState::countUpload(size_t bytes) {
+  state.frame.uploaded += bytes;
+}
+
+void GLState::endFrame() {
+  state.lastFrame = state.frame;
+  state.frame = GLStateStats();
+}
+
+const GLStateStats& GLState::getStats() {
+  return state.lastFrame;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Core libraries
+#include <GL/glew.h>
+#include <stddef.h>
+
+
+/* Blending applied when drawing */
+enum class BlendMode : unsigned char {
+  Opaque    = 0,  // No blending, writes depth
+  Alpha     = 1,  // src * a + dst * (1 - a)
+  Additive  = 2,  // src * a + dst
+};
+
+/* Number of bind calls issued to & skipped before reaching the driver, & bytes uploaded */
+struct GLStateStats {
+  size_t issued   = 0;  // State changes sent to OpenGL
+  size_t skipped  = 0;  // Redundant state changes dropped
+  size_t uploaded = 0;  // Bytes of buffer & texture data sent to OpenGL
+};
+
+/**
+ * Thin state tracking layer over the OpenGL binding points.
+ *  Binds matching the currently bound object are dropped.
+ *
+ * Objects must be deleted through the matching delete function
+ *  so that a recycled object name isn't mistaken as bound.
+ */
+namespace GLState {
+  /* Binds the Program (glUseProgram) */
+  void useProgram(GLuint program);
+
+  /* Binds the Vertex Array Object. The element buffer binding is part of the VAO */
+  void bindVertexArray(GLuint vao);
+
+  /* Binds a Buffer Object to the given target */
+  void bindBuffer(GLenum target, GLuint buffer);
+
+  /* Binds a Texture to the given texture unit & target */
+  void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+  /* Applies the blend mode. Blended draws don't write depth */
+  void setBlendMode(BlendMode mode);
+
+  /* Deletes the objects, unbinding them from the cache */
+  void deleteProgram(GLuint program);
+  void deleteVertexArray(GLuint vao);
+  void deleteBuffer(GLuint buffer);
+  void deleteTexture(GLuint texture);
+
+  /**
+   * Forgets all tracked bindings, forcing the next binds through.
+   *  Used when code outside of GLState modified the bindings.
+   */
+  void invalidate();
+
+  /* Counts bytes of buffer or texture data uploaded this frame */
+  void countUpload(size_t bytes);
+
+  /* Stores the current frame's stats & starts counting a new frame */
+  void endFrame();
+
+  /* Returns the stats of the last finished frame */
+  const GLStateStats& getStats();
+};
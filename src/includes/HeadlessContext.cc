@@ -0,0 +1,111 @@
+#include "HeadlessContext.h"
+
+#include <EGL/eglext.h>
+#include <spdlog/spdlog.h>
+#include <cstring>
+
+/* Mesa's surfaceless platform, from EGL_MESA_platform_surfaceless */
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+
+HeadlessContext::HeadlessContext() :
+  display(EGL_NO_DISPLAY),
+  context(EGL_NO_CONTEXT),
+  surface(EGL_NO_SURFACE) {}
+
+/* Returns whether the space separated extension list contains the given extension */
+static bool hasExtension(const char *extensions, const char *name) {
+  if (!extensions) return false;
+
+  const size_t length = strlen(name);
+  for (const char *it = strstr(extensions, name); it; it = strstr(it + length, name)) {
+    const bool start = it == extensions || it[-1] == ' ';
+    const bool end = it[length] == ' ' || it[length] == '\0';
+    if (start && end) return true;
+  }
+  return false;
+}
+
+bool HeadlessContext::init() {
+  /* 1. Obtain a Display, preferring one that needs no windowing system */
+  const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+      this->display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  if (this->display == EGL_NO_DISPLAY)
+    this->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major, minor;
+  if (this->display == EGL_NO_DISPLAY || !eglInitialize(this->display, &major, &minor)) {
+    spdlog::error("HeadlessContext: Failed to initialize EGL display");
+    return false;
+  }
+  spdlog::info("HeadlessContext: Using EGL {}.{} ({})", major, minor, eglQueryString(this->display, EGL_VENDOR));
+
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    spdlog::error("HeadlessContext: EGL display does not support desktop OpenGL");
+    return false;
+  }
+
+  /* 2. Choose a Config, pbuffer capable in case surfaceless isn't supported */
+  const bool surfaceless = hasExtension(eglQueryString(this->display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+  const EGLint configAttribs[] = {
+    EGL_SURFACE_TYPE,     surfaceless ? 0 : EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE,  EGL_OPENGL_BIT,
+    EGL_RED_SIZE,         8,
+    EGL_GREEN_SIZE,       8,
+    EGL_BLUE_SIZE,        8,
+    EGL_ALPHA_SIZE,       8,
+    EGL_NONE
+  };
+
+  EGLConfig config;
+  EGLint numConfigs = 0;
+  if (!eglChooseConfig(this->display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+    spdlog::error("HeadlessContext: No matching EGL config");
+    return false;
+  }
+
+  /* 3. Create the Context, matching the version the shaders are written for */
+  const EGLint contextAttribs[] = {
+    EGL_CONTEXT_MAJOR_VERSION,        4,
+    EGL_CONTEXT_MINOR_VERSION,        6,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK,  EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE
+  };
+  this->context = eglCreateContext(this->display, config, EGL_NO_CONTEXT, contextAttribs);
+  if (this->context == EGL_NO_CONTEXT) {
+    spdlog::error("HeadlessContext: Failed to create an OpenGL 4.6 Core context [0x{:x}]", eglGetError());
+    return false;
+  }
+
+  /* 4. Make it current, rendering happens on a Framebuffer Object */
+  if (!surfaceless) {
+    const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    this->surface = eglCreatePbufferSurface(this->display, config, pbufferAttribs);
+  }
+
+  if (!eglMakeCurrent(this->display, this->surface, this->surface, this->context)) {
+    spdlog::error("HeadlessContext: Failed to make the context current [0x{:x}]", eglGetError());
+    return false;
+  }
+
+  return true;
+}
+
+void HeadlessContext::destroy() {
+  if (this->display == EGL_NO_DISPLAY) return;
+
+  eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (this->surface != EGL_NO_SURFACE) eglDestroySurface(this->display, this->surface);
+  if (this->context != EGL_NO_CONTEXT) eglDestroyContext(this->display, this->context);
+  eglTerminate(this->display);
+
+  this->display = EGL_NO_DISPLAY;
+  this->context = EGL_NO_CONTEXT;
+  this->surface = EGL_NO_SURFACE;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// Core libraries
+#include <EGL/egl.h>
+
+
+/**
+ * OpenGL Context without any window, through EGL. Used to render
+ *  offscreen on machines without a display (CI, batch jobs).
+ *    - Mesa's surfaceless platform is used when available (llvmpipe
+ *      on GPU-less machines), otherwise the default display.
+ *    - The context is made current without a surface when supported,
+ *      otherwise on a small pbuffer. Rendering targets a Framebuffer.
+ */
+class HeadlessContext {
+  private:
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;     // Pbuffer, EGL_NO_SURFACE when surfaceless.
+
+  public:
+    HeadlessContext();
+
+    /**
+     * Creates an OpenGL 4.6 Core context & makes it current.
+     *	@returns Whether the context is ready to be used
+     */
+    bool init();
+
+    /* Releases the context & display */
+    void destroy();
+};
@@ -0,0 +1,149 @@
+#include "InstancedMesh.h"
+#include "GLState.h"
+#include "TextureCache.h"
+
+#include <cstddef>
+#include <spdlog/spdlog.h>
+
+
+/*
+ ***************************************************************
+ * Instance
+ *	- Builds the 2x3 affine transform of an instance
+ ***************************************************************
+ */
+Instance Instance::make(const glm::vec2 &translation, float radians, const glm::vec2 &scale, const glm::vec2 &origin, const glm::vec4 &tint, float layer) {
+  const float c = glm::cos(radians);
+  const float s = glm::sin(radians);
+
+  // T(translation + origin) * R * S * T(-origin)
+  const float a = c * scale.x, b = -s * scale.y;
+  const float d = s * scale.x, e =  c * scale.y;
+
+  Instance instance;
+  instance.row0[0] = a;
+  instance.row0[1] = b;
+  instance.row0[2] = translation.x + origin.x - (a * origin.x + b * origin.y);
+  instance.row1[0] = d;
+  instance.row1[1] = e;
+  instance.row1[2] = translation.y + origin.y - (d * origin.x + e * origin.y);
+
+  instance.tint[0] = tint.r;
+  instance.tint[1] = tint.g;
+  instance.tint[2] = tint.b;
+  instance.tint[3] = tint.a;
+  instance.layer = layer;
+  return instance;
+}
+
+
+/*
+ ***************************************************************
+ * Constructors & Destructors
+ *	- Uploads the shared mesh and configures the per-instance
+ *	attributes on the mesh's VAO
+ ***************************************************************
+ */
+InstancedMesh::InstancedMesh(const Mesh &geometry, std::shared_ptr<Shader> shader, const char *texturePath) :
+  instanceBuffer(0),
+  instanceCapacity(0),
+  dirty(false),
+  instances({}) {
+  std::shared_ptr<Texture> texture = texturePath ? TextureCache::get().load(texturePath) : nullptr;
+
+  // Textures stored top row first are sampled with v flipped.
+  std::vector<Vertex> flipped;
+  const Vertex *verticies = geometry.verticies.data();
+  if (texture && texture->flipY) {
+    flipped = geometry.verticies;
+    for (Vertex &vertex : flipped) vertex.v = 1.f - vertex.v;
+    verticies = flipped.data();
+  }
+
+  // Geometry is shared and never modified.
+  this->mesh = CreateBuffer::static_float(
+    const_cast<Vertex*>(verticies),
+    geometry.vertex_size_bytes(),
+    const_cast<GLuint*>(geometry.indicies.data()),
+    geometry.index_size_bytes(),
+    shader
+  );
+  this->mesh.texture = texture;
+
+  // Configure the per-instance attributes on the mesh's VAO.
+  glGenBuffers(1, &this->instanceBuffer);
+  GLState::bindVertexArray(this->mesh.VAO);
+  GLState::bindBuffer(GL_ARRAY_BUFFER, this->instanceBuffer);
+
+  VertexLayout layout(sizeof(Instance));
+  layout
+    .add("iRow0",  3, 3, GL_FLOAT,         GL_FALSE, offsetof(Instance, row0))
+    .add("iRow1",  4, 3, GL_FLOAT,         GL_FALSE, offsetof(Instance, row1))
+    .add("iTint",  5, 4, GL_UNSIGNED_BYTE, GL_TRUE,  offsetof(Instance, tint))
+    .add("iLayer", 6, 1, GL_FLOAT,         GL_FALSE, offsetof(Instance, layer))
+    .apply(shader->ID);
+
+  // Advance the instance attributes once per instance, instead of per vertex.
+  for (const VertexAttribute &attr : layout.attributes)
+    glVertexAttribDivisor(attr.location, 1);
+}
+
+InstancedMesh::~InstancedMesh() {
+  GLState::deleteBuffer(this->instanceBuffer);
+  BufferData::freeBufferData(&this->mesh);
+}
+
+
+/*
+ ***************************************************************
+ * Instance Handling
+ *	- Add, Modify & Clear instances
+ *	- Upload & Draw
+ ***************************************************************
+ */
+size_t InstancedMesh::add(const Instance &instance) {
+  this->instances.push_back(instance);
+  this->dirty = true;
+  return this->instances.size() - 1;
+}
+
+void InstancedMesh::set(size_t index, const Instance &instance) {
+  this->instances[index] = instance;
+  this->dirty = true;
+}
+
+void InstancedMesh::clear() {
+  this->instances.clear();
+  this->dirty = true;
+}
+
+void InstancedMesh::update() {
+  if (!this->dirty) return;
+
+  GLState::bindBuffer(GL_ARRAY_BUFFER, this->instanceBuffer);
+  const size_t size = this->instances.size() * sizeof(Instance);
+
+  // Grow the buffer's storage, otherwise update in-place.
+  if (this->instances.size() > this->instanceCapacity) {
+    this->instanceCapacity = this->instances.size();
+    glBufferData(GL_ARRAY_BUFFER, size, this->instances.data(), GL_DYNAMIC_DRAW);
+  } else {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, this->instances.data());
+  }
+  GLState::countUpload(size);
+
+  this->dirty = false;
+}
+
+void InstancedMesh::draw() {
+  if (this->instances.empty()) return;
+  this->update();
+
+  // Tint only, if there's no texture.
+  this->mesh.shader->setUniform("useTexture", this->mesh.texture != nullptr);
+
+  GLState::bindVertexArray(this->mesh.VAO);
+  if (this->mesh.texture) this->mesh.texture->bind(0);
+
+  glDrawElementsInstanced(GL_TRIANGLES, this->mesh.indiciesElts, GL_UNSIGNED_INT, nullptr, this->instances.size());
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Library
+#include "BufferData.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "shapes/Geometry.h"
+
+// Core libraries
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+
+/**
+ * Per-instance attributes, streamed alongside the shared mesh. (32 bytes)
+ *   [ TRANSFORM<2 x vec3 float>   TINT<4 x ubyte, normalized>   LAYER<float> ]
+ *
+ * The transform is a 2x3 affine matrix stored as its two rows.
+ */
+struct Instance {
+  GLfloat row0[3];      // (a, b, tx)
+  GLfloat row1[3];      // (c, d, ty)
+  GLubyte tint[4];      // Color multiplied with the mesh's color/texture
+  GLfloat layer;        // Texture layer
+
+  /**
+   * Builds an instance from a 2D transform, applied around the given origin.
+   *
+   * @param translation Translation of the instance
+   * @param radians Rotation of the instance
+   * @param scale Scale of the instance
+   * @param origin Pivot for rotation & scaling, in mesh space
+   * @param tint Tint color (0-255)
+   * @param layer Texture layer
+   */
+  static Instance make(
+    const glm::vec2 &translation,
+    float radians = 0.f,
+    const glm::vec2 &scale = glm::vec2(1.f),
+    const glm::vec2 &origin = glm::vec2(0.f),
+    const glm::vec4 &tint = glm::vec4(255.f),
+    float layer = 0.f
+  );
+};
+static_assert(sizeof(Instance) == 32, "Instance must be tightly packed");
+
+
+/**
+ * Draws many copies of the same Mesh with a single instanced draw call.
+ *  Geometry is uploaded once and shared, each extra instance only costs
+ *  its Instance attributes.
+ *
+ * Instance attributes live in locations 3 (row0), 4 (row1), 5 (tint)
+ *  and 6 (layer), matching shaders/instanced.vert.
+ */
+class InstancedMesh {
+  private:
+    GLuint instanceBuffer;          // Per-instance attribute buffer
+    size_t instanceCapacity;        // Number of instances the buffer can hold
+    bool dirty;                     // Instances changed since the last upload
+
+  public:
+    BufferData mesh;                    // Shared geometry
+    std::vector<Instance> instances;    // Copy of the instance data
+
+  public:
+    /**
+     * Uploads the mesh & creates the instance buffer.
+     *	@param mesh - Shared geometry
+     *	@param shader - Shader used to draw the instances
+     *	@param texturePath - Optional path to the mesh texture
+     */
+    InstancedMesh(const Mesh&, std::shared_ptr<Shader>, const char*);
+    ~InstancedMesh();
+
+    /* Adds an instance, returning its index */
+    size_t add(const Instance&);
+
+    /* Replaces the instance at the given index */
+    void set(size_t, const Instance&);
+
+    /* Removes all instances */
+    void clear();
+
+    /* Uploads the instance data if it was modified */
+    void update();
+
+    /* Draws all instances, expects the shader to be in use */
+    void draw();
+};
@@ -0,0 +1,329 @@
+#include "Profiler.h"
+
+#include <spdlog/spdlog.h>
+#include <imgui/imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+/* Stack entry of a dropped zone */
+static const size_t DROPPED_ZONE = (size_t)-1;
+
+
+/*
+ ***************************************************************
+ * Constructors & Destructors
+ *	- Profiler is shared, created on first use
+ ***************************************************************
+ */
+Profiler::Profiler() :
+  enabled(false),
+  origin(std::chrono::steady_clock::now()),
+  current({ 0, 0.0, 0.0, {}, 0 }),
+  gpuOffset(0.0),
+  recording(false),
+  frameIndex(0) {
+  for (PendingFrame &frame : this->pending)
+    frame.active = false;
+}
+
+Profiler& Profiler::get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+double Profiler::now() const {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->origin).count();
+}
+
+
+/*
+ ***************************************************************
+ * Frames
+ *	- Each frame's GPU queries wait in a ring slot, read back once
+ *	the last one is available. A slot still waiting when reused
+ *	means the GPU is PROFILER_FRAME_LATENCY frames behind, it is
+ *	then read back with a stall
+ ***************************************************************
+ */
+GLuint Profiler::acquireQuery() {
+  if (this->freeQueries.empty()) {
+    GLuint queries[32];
+    glGenQueries(32, queries);
+    this->freeQueries.insert(this->freeQueries.end(), queries, queries + 32);
+  }
+
+  const GLuint query = this->freeQueries.back();
+  this->freeQueries.pop_back();
+  return query;
+}
+
+bool Profiler::resolve(PendingFrame &frame, bool wait) {
+  if (!frame.active) return true;
+
+  // Queries complete in order, the last one being ready means all are.
+  if (!wait && !frame.queries.empty()) {
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries.back().end, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return false;
+  }
+
+  for (const GpuQuery &query : frame.queries) {
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &end);
+    frame.frame.zones.push_back({
+      query.name,
+      begin * 1e-9 + frame.gpuOffset,
+      end * 1e-9 + frame.gpuOffset,
+      query.depth,
+      true
+    });
+
+    this->freeQueries.push_back(query.begin);
+    this->freeQueries.push_back(query.end);
+  }
+
+  this->history.push_back(std::move(frame.frame));
+  if (this->history.size() > PROFILER_HISTORY)
+    this->history.pop_front();
+
+  frame.queries.clear();
+  frame.active = false;
+  return true;
+}
+
+void Profiler::beginFrame() {
+  // Complete the frames the GPU finished, oldest first.
+  for (size_t i = 0; i < PROFILER_FRAME_LATENCY; i++) {
+    PendingFrame &frame = this->pending[(this->frameIndex + i) % PROFILER_FRAME_LATENCY];
+    if (!this->resolve(frame, false)) break;
+  }
+
+  this->recording = this->enabled;
+  this->cpuStack.clear();
+  this->gpuStack.clear();
+  this->gpuQueries.clear();
+  if (!this->recording) return;
+
+  this->current = { this->frameIndex, this->now(), 0.0, {}, 0 };
+
+  // Align the GPU clock with the CPU's, without waiting on the GPU.
+  GLint64 gpuTime = 0;
+  glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+  this->gpuOffset = this->current.start - gpuTime * 1e-9;
+}
+
+void Profiler::endFrame() {
+  if (!this->recording) return;
+  this->recording = false;
+
+  // Close zones left open.
+  while (!this->gpuStack.empty()) this->popGpu();
+  this->current.end = this->now();
+  for (size_t index : this->cpuStack)
+    if (index != DROPPED_ZONE) this->current.zones[index].end = this->current.end;
+  this->cpuStack.clear();
+
+  PendingFrame &slot = this->pending[this->frameIndex % PROFILER_FRAME_LATENCY];
+  this->resolve(slot, true);
+
+  slot.frame = std::move(this->current);
+  slot.queries.swap(this->gpuQueries);
+  slot.gpuOffset = this->gpuOffset;
+  slot.active = true;
+  this->frameIndex++;
+}
+
+
+/*
+ ***************************************************************
+ * Zones
+ ***************************************************************
+ */
+void Profiler::pushCpu(const char *name) {
+  if (!this->recording) return;
+
+  // Keep the stack balanced for dropped zones.
+  if (this->current.zones.size() >= PROFILER_MAX_ZONES) {
+    this->cpuStack.push_back(DROPPED_ZONE);
+    this->current.dropped++;
+    return;
+  }
+
+  this->cpuStack.push_back(this->current.zones.size());
+  this->current.zones.push_back({ name, this->now(), 0.0, (uint32_t)this->cpuStack.size() - 1, false });
+}
+
+void Profiler::popCpu() {
+  if (!this->recording || this->cpuStack.empty()) return;
+
+  if (this->cpuStack.back() != DROPPED_ZONE)
+    this->current.zones[this->cpuStack.back()].end = this->now();
+  this->cpuStack.pop_back();
+}
+
+void Profiler::pushGpu(const char *name) {
+  if (!this->recording) return;
+
+  GpuQuery query { name, this->acquireQuery(), this->acquireQuery(), (uint32_t)this->gpuStack.size() };
+  glQueryCounter(query.begin, GL_TIMESTAMP);
+
+  this->gpuStack.push_back(this->gpuQueries.size());
+  this->gpuQueries.push_back(query);
+}
+
+void Profiler::popGpu() {
+  if (!this->recording || this->gpuStack.empty()) return;
+
+  glQueryCounter(this->gpuQueries[this->gpuStack.back()].end, GL_TIMESTAMP);
+  this->gpuStack.pop_back();
+}
+
+void Profiler::setEnabled(bool enabled) {
+  this->enabled = enabled;
+}
+
+bool Profiler::isEnabled() const {
+  return this->enabled;
+}
+
+double Profiler::getGpuFrameTime() const {
+  if (!this->enabled || this->history.empty()) return 0.0;
+
+  double time = 0.0;
+  for (const ProfileZone &zone : this->history.back().zones)
+    if (zone.gpu && zone.depth == 0) time += zone.end - zone.start;
+  return time;
+}
+
+const std::deque<ProfileFrame>& Profiler::getHistory() const {
+  return this->history;
+}
+
+void Profiler::destroy() {
+  for (PendingFrame &frame : this->pending) {
+    for (const GpuQuery &query : frame.queries) {
+      this->freeQueries.push_back(query.begin);
+      this->freeQueries.push_back(query.end);
+    }
+    frame.queries.clear();
+    frame.active = false;
+  }
+  for (const GpuQuery &query : this->gpuQueries) {
+    this->freeQueries.push_back(query.begin);
+    this->freeQueries.push_back(query.end);
+  }
+  this->gpuQueries.clear();
+  this->gpuStack.clear();
+  this->recording = false;
+
+  if (!this->freeQueries.empty())
+    glDeleteQueries(this->freeQueries.size(), this->freeQueries.data());
+  this->freeQueries.clear();
+}
+
+
+/*
+ ***************************************************************
+ * Output
+ *	- Timeline of the latest frame, CPU rows above GPU rows
+ *	- Chrome trace, CPU & GPU zones on separate tracks
+ ***************************************************************
+ */
+void Profiler::drawImGui() {
+  if (this->history.empty()) {
+    ImGui::Text("Profiler: waiting for GPU results...");
+    return;
+  }
+
+  const ProfileFrame &frame = this->history.back();
+  uint32_t cpuRows = 0, gpuRows = 0;
+  double gpuStart = frame.end, gpuEnd = frame.start;
+  for (const ProfileZone &zone : frame.zones) {
+    if (zone.gpu) {
+      gpuRows = std::max(gpuRows, zone.depth + 1);
+      gpuStart = std::min(gpuStart, zone.start);
+      gpuEnd = std::max(gpuEnd, zone.end);
+    }
+    else cpuRows = std::max(cpuRows, zone.depth + 1);
+  }
+
+  ImGui::Text("Frame %llu | CPU %.3f ms | GPU %.3f ms", (unsigned long long)frame.index,
+    (frame.end - frame.start) * 1e3, gpuRows ? (gpuEnd - gpuStart) * 1e3 : 0.0);
+  if (frame.dropped)
+    ImGui::Text("%zu zones dropped (over %d)", frame.dropped, PROFILER_MAX_ZONES);
+
+  // Timeline spans the frame & the GPU work it issued.
+  const double start = std::min(frame.start, gpuStart);
+  const double span = std::max(std::max(frame.end, gpuEnd) - start, 1e-6);
+
+  const float rowHeight = 18.f;
+  const ImVec2 origin = ImGui::GetCursorScreenPos();
+  const float width = std::max(ImGui::GetContentRegionAvail().x, 100.f);
+  const float height = rowHeight * (cpuRows + gpuRows + 1);
+  ImDrawList *drawList = ImGui::GetWindowDrawList();
+
+  drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(30, 30, 30, 255));
+  drawList->PushClipRect(origin, ImVec2(origin.x + width, origin.y + height), true);
+
+  for (const ProfileZone &zone : frame.zones) {
+    // GPU rows start below the CPU rows, after a gap.
+    const uint32_t row = zone.gpu ? cpuRows + 1 + zone.depth : zone.depth;
+    const ImVec2 min(origin.x + (float)((zone.start - start) / span) * width, origin.y + row * rowHeight);
+    const ImVec2 max(std::max(origin.x + (float)((zone.end - start) / span) * width, min.x + 1.f), min.y + rowHeight - 1.f);
+
+    const ImU32 color = zone.gpu
+      ? IM_COL32(200, 110, 60, 255)
+      : IM_COL32(70, 130 + (zone.depth * 40) % 120, 200, 255);
+    drawList->AddRectFilled(min, max, color);
+    if (max.x - min.x > 40.f)
+      drawList->AddText(ImVec2(min.x + 3.f, min.y + 2.f), IM_COL32(255, 255, 255, 255), zone.name);
+
+    if (ImGui::IsMouseHoveringRect(min, max))
+      ImGui::SetTooltip("%s (%s)\n%.3f ms", zone.name, zone.gpu ? "GPU" : "CPU", (zone.end - zone.start) * 1e3);
+  }
+
+  drawList->PopClipRect();
+  ImGui::Dummy(ImVec2(width, height));
+}
+
+/* Writes a string as a JSON string literal */
+static void writeJsonString(std::ofstream &out, const char *str) {
+  out << '"';
+  for (; *str; str++) {
+    if (*str == '"' || *str == '\\') out << '\\';
+    out << *str;
+  }
+  out << '"';
+}
+
+bool Profiler::writeChromeTrace(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out.is_open()) {
+    spdlog::error("Profiler: Failed to open '{}'", path);
+    return false;
+  }
+
+  out << "{\"traceEvents\":[\n";
+  out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+  out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+  char number[64];
+  for (const ProfileFrame &frame : this->history) {
+    for (const ProfileZone &zone : frame.zones) {
+      out << ",\n{\"name\":";
+      writeJsonString(out, zone.name);
+      snprintf(number, sizeof(number), "%.3f", zone.start * 1e6);
+      out << ",\"cat\":\"" << (zone.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"ts\":" << number;
+      snprintf(number, sizeof(number), "%.3f", (zone.end - zone.start) * 1e6);
+      out << ",\"dur\":" << number << ",\"pid\":0,\"tid\":" << (zone.gpu ? 1 : 0)
+          << ",\"args\":{\"frame\":" << frame.index << "}}";
+    }
+  }
+  out << "\n]}\n";
+
+  if (!out.good()) return false;
+  spdlog::info("Profiler: Wrote {} frames to '{}'", this->history.size(), path);
+  return true;
+}
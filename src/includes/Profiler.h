@@ -0,0 +1,170 @@
+#pragma once
+
+// Core libraries
+#include <GL/glew.h>
+#include <chrono>
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/* Frames the GPU may lag behind before its timer queries are read back */
+#define PROFILER_FRAME_LATENCY 4
+
+/* Completed frames kept for the timeline & trace export */
+#define PROFILER_HISTORY 240
+
+/* Max CPU zones recorded per frame, later zones are dropped */
+#define PROFILER_MAX_ZONES 4096
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+/* Profiles the CPU time of the enclosing scope, under a string literal name */
+#define PROFILE_SCOPE(name) ProfileScope PROFILER_CONCAT(profileScope, __LINE__)(name)
+
+/* Profiles the GPU time of the commands issued in the enclosing scope */
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILER_CONCAT(gpuProfileScope, __LINE__)(name)
+
+
+/* Named span of a frame, in seconds since the Profiler started */
+struct ProfileZone {
+  const char *name;
+  double start, end;
+  uint32_t depth;       // Nesting depth, 0 for top level zones
+  bool gpu;             // Whether timed on the GPU
+};
+
+/* Zones recorded in a frame, GPU zones added once their queries are read */
+struct ProfileFrame {
+  uint64_t index;
+  double start, end;    // CPU time of the frame
+  std::vector<ProfileZone> zones;
+  size_t dropped;       // CPU zones over PROFILER_MAX_ZONES
+};
+
+
+/**
+ * Frame profiler with nestable, named CPU & GPU zones.
+ *  - CPU zones are timed with a steady clock, on the render thread
+ *  - GPU zones are timed with GL_TIMESTAMP queries, read back up to
+ *  PROFILER_FRAME_LATENCY frames later once available, so profiling
+ *  never stalls the pipeline. GPU times are mapped onto the CPU timeline
+ *  through the GL timestamp sampled at the start of each frame
+ *  - Completed frames are shown as a timeline in ImGui & exported as
+ *  Chrome trace JSON (chrome://tracing, Perfetto)
+ */
+class Profiler {
+  private:
+    /* Timestamp queries of a GPU zone */
+    struct GpuQuery {
+      const char *name;
+      GLuint begin, end;
+      uint32_t depth;
+    };
+
+    /* Frame waiting for its GPU queries */
+    struct PendingFrame {
+      ProfileFrame frame;
+      std::vector<GpuQuery> queries;
+      double gpuOffset;               // CPU time minus GPU time, in seconds
+      bool active;
+    };
+
+  private:
+    bool enabled;
+    std::chrono::steady_clock::time_point origin;
+
+    // Frame being recorded.
+    ProfileFrame current;
+    std::vector<size_t> cpuStack;     // Open CPU zones, indices into current.zones
+    std::vector<GpuQuery> gpuQueries;
+    std::vector<size_t> gpuStack;     // Open GPU zones, indices into gpuQueries
+    double gpuOffset;
+    bool recording;
+
+    PendingFrame pending[PROFILER_FRAME_LATENCY];
+    std::vector<GLuint> freeQueries;
+    std::deque<ProfileFrame> history;
+    uint64_t frameIndex;
+
+  private:
+    Profiler();
+
+    /* Returns a timestamp query object, from the pool */
+    GLuint acquireQuery();
+
+    /**
+     * Reads back the GPU zones of a pending frame, completing it.
+     *	@param frame - Frame waiting for its queries
+     *	@param wait - Whether to wait for results not yet available
+     *	@returns Whether the frame was completed
+     */
+    bool resolve(PendingFrame &frame, bool wait);
+
+  public:
+    /* Returns the profiler shared by the engine */
+    static Profiler& get();
+
+    /* Returns the CPU time in seconds since the Profiler started */
+    double now() const;
+
+    /* Starts recording a frame, reading back finished GPU queries */
+    void beginFrame();
+
+    /* Ends the recorded frame, its GPU zones complete frames later */
+    void endFrame();
+
+    /**
+     * Opens & closes a named CPU zone, nested in the open zones.
+     *	@param name - Name of the zone, must outlive the Profiler
+     */
+    void pushCpu(const char *name);
+    void popCpu();
+
+    /**
+     * Opens & closes a named GPU zone, around the GL commands issued between.
+     *	@param name - Name of the zone, must outlive the Profiler
+     */
+    void pushGpu(const char *name);
+    void popGpu();
+
+    /* Turns recording on or off, taking effect on the next frame. Off by default */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    /* Returns the GPU time in seconds of the latest completed frame, 0 if none or not recording */
+    double getGpuFrameTime() const;
+
+    /* Returns the completed frames, oldest first */
+    const std::deque<ProfileFrame>& getHistory() const;
+
+    /* Draws the latest completed frame as a timeline, within an ImGui window */
+    void drawImGui();
+
+    /**
+     * Writes the completed frames as Chrome trace JSON.
+     *	@param path - Output file
+     *	@returns Whether the file was written
+     */
+    bool writeChromeTrace(const std::string &path) const;
+
+    /* Releases the GL query objects, while the GL Context is current */
+    void destroy();
+};
+
+
+/* Profiles a CPU zone over its lifetime, see PROFILE_SCOPE */
+class ProfileScope {
+  public:
+    ProfileScope(const char *name) { Profiler::get().pushCpu(name); }
+    ~ProfileScope() { Profiler::get().popCpu(); }
+};
+
+/* Profiles a GPU zone over its lifetime, see PROFILE_GPU_SCOPE */
+class GpuProfileScope {
+  public:
+    GpuProfileScope(const char *name) { Profiler::get().pushGpu(name); }
+    ~GpuProfileScope() { Profiler::get().popGpu(); }
+};
@@ -0,0 +1,87 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+
+
+/*
+ ***************************************************************
+ * Sort Keys
+ *	- Packs the draw state into a 64-bit key
+ ***************************************************************
+ */
+uint64_t RenderQueue::makeKey(GLuint program, GLuint texture, BlendMode blend, short layer) {
+  // Flip the sign bit so negative layers sort before positive ones.
+  const uint64_t layerBits = (uint16_t)layer ^ 0x8000;
+  uint64_t key = layerBits << 48;
+
+  // Translucent draws keep their submission order within the layer.
+  if (blend != BlendMode::Opaque)
+    return key | (1ull << 47);
+
+  key |= ((uint64_t)blend & 0x7) << 44;
+  key |= ((uint64_t)program & 0xFFFFF) << 24;
+  key |= ((uint64_t)texture & 0xFFFFFF);
+  return key;
+}
+
+
+/*
+ ***************************************************************
+ * Queue Handling
+ *	- Submit, Sort & Clear queued draws
+ ***************************************************************
+ */
+void RenderQueue::submit(Shape *shape) {
+  const BufferData &bd = shape->buffer;
+  const GLuint texture = bd.texture ? bd.texture->textureID : 0;
+
+  this->items.push_back({
+    makeKey(bd.shader->ID, texture, shape->get_blend_mode(), shape->get_layer()),
+    shape
+  });
+}
+
+void RenderQueue::sort() {
+  const size_t count = this->items.size();
+  if (count < 2) return;
+  this->scratch.resize(count);
+
+  RenderItem *src = this->items.data();
+  RenderItem *dst = this->scratch.data();
+
+  // One pass per byte, least significant first.
+  for (unsigned int shift = 0; shift < 64; shift += 8) {
+    size_t histogram[256];
+    memset(histogram, 0, sizeof(histogram));
+    for (size_t i = 0; i < count; i++)
+      histogram[(src[i].key >> shift) & 0xFF]++;
+
+    // All keys share this byte, nothing to reorder.
+    if (histogram[(src[0].key >> shift) & 0xFF] == count) continue;
+
+    // Convert the counts into offsets.
+    size_t offset = 0;
+    for (size_t &bucket : histogram) {
+      const size_t n = bucket;
+      bucket = offset;
+      offset += n;
+    }
+
+    for (size_t i = 0; i < count; i++)
+      dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+    std::swap(src, dst);
+  }
+
+  // Sorted result ended up in the scratch buffer.
+  if (src != this->items.data())
+    this->items.swap(this->scratch);
+}
+
+const std::vector<RenderItem>& RenderQueue::getItems() const {
+  return this->items;
+}
+
+void RenderQueue::clear() {
+  this->items.clear();
+}
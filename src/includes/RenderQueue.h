@@ -0,0 +1,57 @@
+#pragma once
+
+// Library
+#include "GLState.h"
+#include "shapes/Shape.h"
+
+// Core libraries
+#include <GL/glew.h>
+#include <stdint.h>
+#include <vector>
+
+
+/* Queued draw, ordered by its sort key */
+struct RenderItem {
+  uint64_t key;   // Sort key (See RenderQueue::makeKey)
+  Shape *shape;   // Shape to draw
+};
+
+/**
+ * Orders draws by a 64-bit sort key before they are submitted,
+ *  so draws sharing GPU state end up next to each other.
+ *
+ * Key layout, from the most significant bit:
+ *   [ LAYER<16>  TRANSLUCENT<1>  BLEND<3>  PROGRAM<20>  TEXTURE<24> ]
+ *
+ * Layers are drawn back to front. Within a layer, opaque draws
+ *  come first, sorted by state. Translucent draws only key on
+ *  their layer, the stable sort keeps them in submission
+ *  (back to front) order.
+ */
+class RenderQueue {
+  private:
+    std::vector<RenderItem> items;      // Queued draws
+    std::vector<RenderItem> scratch;    // Radix sort swap buffer
+
+  public:
+    /**
+     * Builds the sort key of a draw.
+     *	@param program - Program ID
+     *	@param texture - Texture ID, 0 if none
+     *	@param blend - Blend mode of the draw
+     *	@param layer - Draw layer, higher layers are drawn on top
+     */
+    static uint64_t makeKey(GLuint program, GLuint texture, BlendMode blend, short layer);
+
+    /* Queues a Shape to be drawn */
+    void submit(Shape*);
+
+    /* Stable LSD radix sort of the queued draws by their key */
+    void sort();
+
+    /* Returns the queued draws */
+    const std::vector<RenderItem>& getItems() const;
+
+    /* Removes all queued draws */
+    void clear();
+};
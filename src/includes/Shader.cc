@@ -1,12 +1,45 @@
 #include "Shader.h"
+#include "AssetPack.h"
+#include "GLState.h"
+#include "UniformBuffer.h"
 
+#include <cstring>
 #include <fstream>
+#include <glm/gtc/type_ptr.hpp>
 #include <spdlog/spdlog.h>
 #include <sys/stat.h>
 
 
-Shader::Shader() : ID(0), ready(false) {};              // No Shader Given
-Shader::Shader(GLuint _id) : ID(_id), ready(true) {};   // Initialize Shader to precompiled Program
+/* Reads a shader source from the mounted pack, or the filesystem */
+static bool readSource(const std::string &path, std::string &source) {
+  Asset asset;
+  if (AssetPack::get().find(path, asset)) {
+    source.assign(reinterpret_cast<const char*>(asset.data), asset.size);
+    return true;
+  }
+
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    spdlog::error("Shader Initialize: Source Code {} could not be loaded", path.c_str());
+    return false;
+  }
+
+  source.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  return true;
+}
+
+/* Obtains last updated time of given file */
+static time_t getLastModified(const char* filename) {
+  struct stat st;
+  if (stat(filename, &st) == 0) {
+    return st.st_mtime;
+  }
+
+  return -1;
+}
+
+Shader::Shader() : vertStage(0), fragStage(0), linking(false), ID(0), ready(false) {};              // No Shader Given
+Shader::Shader(GLuint _id) : vertStage(0), fragStage(0), linking(false), ID(_id), ready(true) {};   // Initialize Shader to precompiled Program
 Shader::~Shader() { this->deleteShader(); }
 
 /*
@@ -19,12 +52,14 @@ Shader::~Shader() { this->deleteShader(); }
  */
 
 void Shader::use() {
+  // First use of a submitted program, check its link.
+  if (linking) this->finish();
+
   if (ready) {
-    glUseProgram(ID);  // Make Sure ther IS a Valid Program ID
+    GLState::useProgram(ID);  // Make Sure ther IS a Valid Program ID
 
     // Update uniform to enable the use of the texture.
-    GLint uniformUseTexture   = glGetUniformLocation(ID, "useTexture");
-    glUniform1ui(uniformUseTexture, true);
+    this->setUniform("useTexture", true);
   }
   else
     spdlog::error("Shader Struct: No Program to use!");
@@ -38,6 +73,11 @@ void Shader::use() {
  * Error: Returns 0 if Shader Failed
  */
 GLuint loadShader(std::string srcFile, GLenum shaderType) {
+  // Packed Sources are compiled straight from the mapping
+  Asset asset;
+  if (AssetPack::get().find(srcFile, asset))
+    return compileShader(reinterpret_cast<const char*>(asset.data), asset.size, shaderType);
+
   // Load in Source Code
   std::ifstream in(srcFile);
   if (!in.is_open())
@@ -49,11 +89,13 @@ GLuint loadShader(std::string srcFile, GLenum shaderType) {
   );
   in.close();
 
-  const char *c_str = vertSrc.c_str();
+  return compileShader(vertSrc.c_str(), vertSrc.size(), shaderType);
+}
 
+GLuint compileShader(const char *src, GLint length, GLenum shaderType) {
   // Compile and Store Shader
   GLuint shaderID = glCreateShader(shaderType);  // Stores Reference ID
-  glShaderSource(shaderID, 1, &c_str, NULL);
+  glShaderSource(shaderID, 1, &src, &length);
   glCompileShader(shaderID);
 
 
@@ -64,83 +106,304 @@ GLuint loadShader(std::string srcFile, GLenum shaderType) {
   if (!success) {
     glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
     spdlog::error("Initialize Shaders: Error in Compiling Shader Source!\n {}", infoLog);
-    return -1;
+    glDeleteShader(shaderID);
+    return 0;
   }
 
   // Return the Shader Reference ID Created
   return shaderID;
 }
 
+void Shader::setSources(const std::string &vertPath, const std::string &fragPath) {
+  this->vertexShaderFilepath = vertPath;
+  this->fragmentShaderFilepath = fragPath;
+  this->VshaderLastMod = getLastModified(vertPath.c_str());
+  this->FshaderLastMod = getLastModified(fragPath.c_str());
+}
+
 void Shader::compile(const char *vertFilePath, const char *fragFilePath) {
   // Store a copy of the shader file paths.
-  this->fragmentShaderFilepath = fragFilePath;
-  this->vertexShaderFilepath = vertFilePath;
+  this->setSources(vertFilePath, fragFilePath);
 
   // Initialize the Shaders
-  GLuint fragShader = loadShader(fragFilePath, GL_FRAGMENT_SHADER);
-  GLuint vertShader = loadShader(vertFilePath, GL_VERTEX_SHADER);
+  std::string vertSrc, fragSrc;
+  if (!readSource(vertFilePath, vertSrc) || !readSource(fragFilePath, fragSrc)) {
+    this->deleteShader();
+    ID = 0;
+    ready = false;
+    return;
+  }
+  this->compileSource(vertSrc.c_str(), vertSrc.size(), fragSrc.c_str(), fragSrc.size());
+}
+
+void Shader::compileSource(const char *vertSrc, size_t vertLength, const char *fragSrc, size_t fragLength) {
+  this->submit(vertSrc, vertLength, fragSrc, fragLength);
+  this->finish();
+}
 
+void Shader::submit(const char *vertSrc, size_t vertLength, const char *fragSrc, size_t fragLength) {
   // Make sure to clean up program before creating a new one.
   this->deleteShader();
 
-  // Make sure Fragment Shaders Compiled Correctly
-  // Attach & Link Shaders
-  if (vertShader != 0 && fragShader != 0) {
-    ID = glCreateProgram();
+  const GLint vertSize = vertLength, fragSize = fragLength;
+  vertStage = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertStage, 1, &vertSrc, &vertSize);
+  glCompileShader(vertStage);
 
-    glAttachShader(ID, vertShader);
-    glAttachShader(ID, fragShader);
-    glLinkProgram(ID);
+  fragStage = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragStage, 1, &fragSrc, &fragSize);
+  glCompileShader(fragStage);
 
-    // Check for Linking Errors
-    char infoLog[512];
-    int success;
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success) {
-      glGetProgramInfoLog(ID, 512, NULL, infoLog);
-      spdlog::error("Program Linking ERROR: Failed to link\n {}", infoLog);
+  // Linking does not wait on the compiles, errors show up as a failed link.
+  ID = glCreateProgram();
+  glAttachShader(ID, vertStage);
+  glAttachShader(ID, fragStage);
+  glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  glLinkProgram(ID);
+
+  linking = true;
+  ready = false;
+}
 
-      ready = false;
+bool Shader::poll() {
+  if (!linking) return true;
+
+  if (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile) {
+    GLint completed = GL_FALSE;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &completed);
+    if (!completed) return false;
+  }
+
+  this->finish();
+  return true;
+}
+
+void Shader::finish() {
+  if (!linking) return;
+  linking = false;
+
+  char infoLog[512];
+  int success;
+  glGetProgramiv(ID, GL_LINK_STATUS, &success);
+  if (!success) {
+    // Report the stage that failed, if any, over the link error.
+    const GLuint stages[2] = { vertStage, fragStage };
+    bool compiled = true;
+    for (GLuint stage : stages) {
+      glGetShaderiv(stage, GL_COMPILE_STATUS, &success);
+      if (!success) {
+        glGetShaderInfoLog(stage, 512, NULL, infoLog);
+        spdlog::error("Initialize Shaders: Error in Compiling Shader Source!\n {}", infoLog);
+        compiled = false;
+      }
     }
 
-    // Success
-    else {
-      spdlog::info("Program Shader[{}] Compiled Successfuly!", ID);
-      ready = true;
+    if (compiled) {
+      glGetProgramInfoLog(ID, 512, NULL, infoLog);
+      spdlog::error("Program Linking ERROR: Failed to link\n {}", infoLog);
     }
+    ready = false;
+  }
+
+  // Success
+  else {
+    spdlog::info("Program Shader[{}] Compiled Successfuly!", ID);
+    ready = true;
+    this->reflectUniforms();
+  }
+
+  // Delete Shaders
+  glDeleteShader(vertStage);
+  glDeleteShader(fragStage);
+  vertStage = fragStage = 0;
+}
+
+bool Shader::isLinking() const {
+  return linking;
+}
+
+bool Shader::reload() {
+  if (this->vertexShaderFilepath.empty() || this->fragmentShaderFilepath.empty()) return false;
+
+  std::string vertSrc, fragSrc;
+  if (!readSource(this->vertexShaderFilepath, vertSrc) || !readSource(this->fragmentShaderFilepath, fragSrc)) {
+    spdlog::warn("Shader[{}]: Reload failed, keeping the last good program", ID);
+    return false;
+  }
+
+  if (!this->reloadSource(vertSrc.c_str(), vertSrc.size(), fragSrc.c_str(), fragSrc.size())) return false;
+  this->setSources(this->vertexShaderFilepath, this->fragmentShaderFilepath);
+  return true;
+}
+
+bool Shader::reloadSource(const char *vertSrc, size_t vertLength, const char *fragSrc, size_t fragLength) {
+  // Compile into a separate program, only replacing this one on success.
+  Shader next;
+  next.compileSource(vertSrc, vertLength, fragSrc, fragLength);
+  if (!next.ready) {
+    spdlog::warn("Shader[{}]: Reload failed, keeping the last good program", ID);
+    return false;
+  }
+
+  this->deleteShader();
+  ID = next.ID;
+  ready = true;
+  this->uniforms = std::move(next.uniforms);
+
+  next.ID = 0;
+  next.ready = false;
+  return true;
+}
+
+bool Shader::loadBinary(GLenum format, const void *binary, GLsizei length) {
+  this->deleteShader();
+
+  ID = glCreateProgram();
+  glProgramBinary(ID, format, binary, length);
 
-    // Delete Shaders
-    if (vertShader != 0)
-      glDeleteShader(vertShader);
-    if (fragShader != 0)
-      glDeleteShader(fragShader);
+  // Binaries from another driver fail to link, without an error.
+  int success;
+  glGetProgramiv(ID, GL_LINK_STATUS, &success);
+  if (!success) {
+    this->deleteShader();
+    ID = 0;
+    ready = false;
+    return false;
   }
+
+  ready = true;
+  this->reflectUniforms();
+  return true;
+}
+
+bool Shader::getBinary(GLenum &format, std::vector<unsigned char> &binary) const {
+  if (!ready) return false;
+
+  GLint length = 0;
+  glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return false;
+
+  binary.resize(length);
+  glGetProgramBinary(ID, length, &length, &format, binary.data());
+  binary.resize(length);
+  return length > 0;
 }
 
 void Shader::deleteShader() {
+  // Drop a link still in flight.
+  if (this->linking) {
+    glDeleteShader(this->vertStage);
+    glDeleteShader(this->fragStage);
+    this->vertStage = this->fragStage = 0;
+    this->linking = false;
+  }
+
   if (this->ID != 0) {
-    glDeleteProgram(this->ID);
+    GLState::deleteProgram(this->ID);
   }
+  this->uniforms.clear();
 }
 
+
 /**
  ***********************************************************
- * Live re-loads the shader if the file was modified.
- *		- Shaders
+ * Uniform Handling
+ *		- Reflects active uniforms once per link
+ *		- Typed setters, skipping redundant uploads
  ***********************************************************
- * Error: Returns 0 if Shader Failed
  */
+void Shader::reflectUniforms() {
+  this->uniforms.clear();
 
-/* Obtains last updated time of given file */
-static time_t getLastModified(const char* filename) {
-  struct stat st;
-  if (stat(filename, &st) == 0) {
-    return st.st_mtime;
+  GLint count = 0, maxLength = 0;
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+  std::string name(maxLength, '\0');
+  for (GLint i = 0; i < count; i++) {
+    GLsizei length = 0;
+    Uniform uniform {};
+    glGetActiveUniform(ID, i, maxLength, &length, &uniform.size, &uniform.type, &name[0]);
+
+    // Uniforms within a block have no location.
+    std::string uniformName = name.substr(0, length);
+    uniform.location = glGetUniformLocation(ID, uniformName.c_str());
+    if (uniform.location < 0) continue;
+
+    // Arrays are reported as "name[0]", store them by their base name.
+    const size_t bracket = uniformName.find('[');
+    if (bracket != std::string::npos) uniformName.resize(bracket);
+
+    this->uniforms[uniformName] = uniform;
   }
 
-  return -1;
+  // Link the per-frame globals to the shared uniform buffer.
+  GLuint frameBlock = glGetUniformBlockIndex(ID, FRAME_DATA_BLOCK_NAME);
+  if (frameBlock != GL_INVALID_INDEX)
+    glUniformBlockBinding(ID, frameBlock, FRAME_DATA_BINDING);
+}
+
+GLint Shader::getUniformLocation(const std::string &name) const {
+  auto it = this->uniforms.find(name);
+  return it == this->uniforms.end() ? -1 : it->second.location;
 }
 
+Shader::Uniform* Shader::changed(const char *name, const void *value, size_t size) {
+  if (this->linking) this->finish();
+
+  auto it = this->uniforms.find(name);
+  if (it == this->uniforms.end()) return nullptr;
+
+  Uniform &uniform = it->second;
+  if (uniform.cached && memcmp(uniform.value, value, size) == 0) return nullptr;
+
+  memcpy(uniform.value, value, size);
+  uniform.cached = true;
+  return &uniform;
+}
+
+void Shader::setUniform(const char *name, bool value) {
+  this->setUniform(name, (GLint)value);
+}
+
+void Shader::setUniform(const char *name, GLint value) {
+  if (Uniform *u = this->changed(name, &value, sizeof(value)))
+    glProgramUniform1i(ID, u->location, value);
+}
+
+void Shader::setUniform(const char *name, GLuint value) {
+  if (Uniform *u = this->changed(name, &value, sizeof(value)))
+    glProgramUniform1ui(ID, u->location, value);
+}
+
+void Shader::setUniform(const char *name, GLfloat value) {
+  if (Uniform *u = this->changed(name, &value, sizeof(value)))
+    glProgramUniform1f(ID, u->location, value);
+}
+
+void Shader::setUniform(const char *name, const glm::vec2 &value) {
+  if (Uniform *u = this->changed(name, glm::value_ptr(value), sizeof(value)))
+    glProgramUniform2fv(ID, u->location, 1, glm::value_ptr(value));
+}
+
+void Shader::setUniform(const char *name, const glm::vec4 &value) {
+  if (Uniform *u = this->changed(name, glm::value_ptr(value), sizeof(value)))
+    glProgramUniform4fv(ID, u->location, 1, glm::value_ptr(value));
+}
+
+void Shader::setUniform(const char *name, const glm::mat4 &value) {
+  if (Uniform *u = this->changed(name, glm::value_ptr(value), sizeof(value)))
+    glProgramUniformMatrix4fv(ID, u->location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+/**
+ ***********************************************************
+ * Live re-loads the shader if the file was modified.
+ *		- Shaders
+ ***********************************************************
+ * Error: Returns 0 if Shader Failed
+ */
+
 /* Updates Shaders Live */
 void Shader::liveGLSLUpdateShaders() {
   // Early return if no shaders have been compiled yet.
@@ -150,12 +413,15 @@ void Shader::liveGLSLUpdateShaders() {
   time_t newFshaderLastMod = getLastModified(this->fragmentShaderFilepath.c_str());
   time_t newVshaderLastMod = getLastModified(this->vertexShaderFilepath.c_str());
 
+  // Packed shaders have no loose files to watch.
+  if (newFshaderLastMod < 0 || newVshaderLastMod < 0) return;
+
   if (newFshaderLastMod != FshaderLastMod || newVshaderLastMod != VshaderLastMod) {
     FshaderLastMod = newFshaderLastMod;
     VshaderLastMod = newVshaderLastMod;
 
     // Re-Compile Shaders
     // Attach & Link Shaders & Use
-    this->compile(this->vertexShaderFilepath.c_str(), this->fragmentShaderFilepath.c_str());
+    this->reload();
   }
 }
\ No newline at end of file
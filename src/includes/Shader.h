@@ -1,16 +1,52 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // Structure for Better Shader Handling
 class Shader {
+  friend class ShaderCache;
+
+  private:
+    /* Active uniform, reflected once the program is linked */
+    struct Uniform {
+      GLint location;       // Uniform location
+      GLenum type;          // Uniform type (GL_FLOAT_VEC2, ...)
+      GLint size;           // Array size
+      bool cached;          // Whether value holds the last uploaded value
+      GLubyte value[64];    // Last uploaded value (Up to a mat4)
+    };
+
   private:
     // Paths to compiled shaders.
     std::string vertexShaderFilepath;
     std::string fragmentShaderFilepath;
     time_t FshaderLastMod = 0, VshaderLastMod = 0;
 
+    // Active uniforms by name.
+    std::unordered_map<std::string, Uniform> uniforms;
+
+    // Stages of a submitted link, checked once the program is first used.
+    GLuint vertStage, fragStage;
+    bool linking;
+
+  private:
+    /* Stores the source paths & their modification times, for live updates */
+    void setSources(const std::string &vertPath, const std::string &fragPath);
+
+    /* Queries the active uniforms & uniform blocks of the linked program */
+    void reflectUniforms();
+
+    /**
+     * Checks if the uniform's value changed since the last upload,
+     *  storing the new value if so.
+     * @return Uniform to upload to, nullptr if inactive or unchanged
+     */
+    Uniform* changed(const char *name, const void *value, size_t size);
+
   public:
     GLuint ID;     // Store Compiled Shader Program
     bool ready;    // Keep track of Shader Status (False = Not Ready | True = Ready)
@@ -22,14 +58,112 @@ class Shader {
 
     void use();                               // Uses Current Program (If any)
     void compile(const char*, const char*);   // Compiles Given Shader Files (Vertex, Fragment)
-    void liveGLSLUpdateShaders();             // Updates the shader if the filepath was modified.
+
+    /**
+     * Compiles Shader Sources in memory, used as-is without copies.
+     *	@param vertSrc - Vertex Shader Source
+     *	@param vertLength - Length of the Vertex Shader Source
+     *	@param fragSrc - Fragment Shader Source
+     *	@param fragLength - Length of the Fragment Shader Source
+     */
+    void compileSource(const char *vertSrc, size_t vertLength, const char *fragSrc, size_t fragLength);
+
+    /**
+     * Starts compiling & linking Shader Sources in memory, without waiting
+     *  for the driver. The link status is only checked when the program is
+     *  first used, so programs submitted together compile in parallel when
+     *  the driver supports KHR_parallel_shader_compile.
+     *	@param vertSrc - Vertex Shader Source
+     *	@param vertLength - Length of the Vertex Shader Source
+     *	@param fragSrc - Fragment Shader Source
+     *	@param fragLength - Length of the Fragment Shader Source
+     */
+    void submit(const char *vertSrc, size_t vertLength, const char *fragSrc, size_t fragLength);
+
+    /**
+     * Returns whether a submitted link completed, without blocking when the
+     *  driver compiles in parallel. The program is checked once it has.
+     */
+    bool poll();
+
+    /* Waits for a submitted link & checks it, setting ready */
+    void finish();
+
+    /* Returns whether a submitted link has not been checked yet */
+    bool isLinking() const;
+
+    /**
+     * Loads a program binary retrieved with getBinary(). Drivers reject
+     *  binaries from other versions or hardware.
+     *	@param format - Binary Format of the Program Binary
+     *	@param binary - Program Binary
+     *	@param length - Size of the Program Binary in bytes
+     *	@returns Whether the binary was accepted & linked
+     */
+    bool loadBinary(GLenum format, const void *binary, GLsizei length);
+
+    /**
+     * Retrieves the linked program's binary, for loadBinary() in later runs.
+     *	@param format - Set to the Binary Format
+     *	@param binary - Filled with the Program Binary
+     *	@returns Whether the program is linked & has a binary
+     */
+    bool getBinary(GLenum &format, std::vector<unsigned char> &binary) const;
+
+    /**
+     * Recompiles the program from its source files. The current program is
+     *  only replaced once the new one links, so a broken edit keeps the last
+     *  good program running.
+     *	@returns Whether the program was replaced
+     */
+    bool reload();
+
+    /**
+     * Recompiles the program from Shader Sources in memory, replacing the
+     *  current one only once the new one links.
+     *	@param vertSrc - Vertex Shader Source
+     *	@param vertLength - Length of the Vertex Shader Source
+     *	@param fragSrc - Fragment Shader Source
+     *	@param fragLength - Length of the Fragment Shader Source
+     *	@returns Whether the program was replaced
+     */
+    bool reloadSource(const char *vertSrc, size_t vertLength, const char *fragSrc, size_t fragLength);
+
+    void liveGLSLUpdateShaders();             // Updates the shader if the filepath was modified (polls, see ShaderCache::setLiveUpdate).
     void deleteShader();                      // Cleans up shader.
+
+    /* Returns the cached uniform location, -1 if not an active uniform */
+    GLint getUniformLocation(const std::string &name) const;
+
+    /**
+     * Typed uniform setters. Uploads are skipped when the value
+     *  did not change since the last upload.
+     *	@param name - Name of the uniform
+     *	@param value - Value to upload
+     */
+    void setUniform(const char *name, bool value);
+    void setUniform(const char *name, GLint value);
+    void setUniform(const char *name, GLuint value);
+    void setUniform(const char *name, GLfloat value);
+    void setUniform(const char *name, const glm::vec2 &value);
+    void setUniform(const char *name, const glm::vec4 &value);
+    void setUniform(const char *name, const glm::mat4 &value);
 };
 
 /**
- * Initializes Source Code of given shaderType
+ * Initializes Source Code of given shaderType. The mounted AssetPack
+ *  is looked up first, then the filesystem.
  * @param srcFile - The Source Code path for the Shader
  * @param shaderType - The Shader Type
- * @return - Shader Reference ID, Returns -1 if Failed
+ * @return - Shader Reference ID, Returns 0 if Failed
+ */
+GLuint loadShader(std::string srcFile, GLenum shaderType);
+
+/**
+ * Compiles Shader Source Code in memory of given shaderType
+ * @param src - The Source Code, not necessarily null terminated
+ * @param length - Length of the Source Code
+ * @param shaderType - The Shader Type
+ * @return - Shader Reference ID, Returns 0 if Failed
  */
-GLuint loadShader(std::string srcFile, GLenum shaderType);
\ No newline at end of file
+GLuint compileShader(const char *src, GLint length, GLenum shaderType);
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include "ShaderCache.h"
+#include "AssetPack.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+
+/* Source of a shader stage, pointing into the pack or storage */
+struct ShaderSource {
+  const char *data;
+  size_t size;
+  std::string storage;    // Empty when packed
+};
+
+/* Returns the key a source file is watched under */
+static std::string watchKey(const std::string &path) {
+  return std::filesystem::path(path).lexically_normal().string();
+}
+
+/* Reads a shader source from the mounted pack, or the filesystem */
+static bool readSource(const std::string &path, ShaderSource &source) {
+  Asset asset;
+  if (AssetPack::get().find(path, asset)) {
+    source.data = reinterpret_cast<const char*>(asset.data);
+    source.size = asset.size;
+    return true;
+  }
+
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    spdlog::error("ShaderCache: Source Code {} could not be loaded", path);
+    return false;
+  }
+
+  source.storage.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  source.data = source.storage.data();
+  source.size = source.storage.size();
+  return true;
+}
+
+/* Folds bytes into a 64-bit FNV-1a hash */
+static uint64_t hashBytes(uint64_t h, const void *data, size_t size) {
+  const unsigned char *bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; i++) {
+    h ^= bytes[i];
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+/* Returns the key of a (vertex, fragment) pair of sources */
+static uint64_t sourceKey(const ShaderSource &vert, const ShaderSource &frag) {
+  uint64_t key = 0xcbf29ce484222325ull;
+  key = hashBytes(key, vert.data, vert.size);
+  key = hashBytes(key, "", 1);
+  return hashBytes(key, frag.data, frag.size);
+}
+
+
+/*
+ ***************************************************************
+ * Constructors & Destructors
+ *	- Cache is shared, created on first use
+ ***************************************************************
+ */
+ShaderCache::ShaderCache() :
+  parallel(false),
+  directory(SHADER_CACHE_DIR),
+  compiled(0),
+  cached(0),
+  linked(0) {}
+
+ShaderCache& ShaderCache::get() {
+  static ShaderCache cache;
+  return cache;
+}
+
+
+/*
+ ***************************************************************
+ * Program Binaries
+ *	- One file per program, written to a temporary file & renamed
+ *	so a crashed run never leaves a truncated binary behind
+ ***************************************************************
+ */
+std::string ShaderCache::binaryPath(uint64_t key) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+  return this->directory + "/" + name;
+}
+
+bool ShaderCache::loadBinary(Shader &shader, uint64_t key) const {
+  const std::string path = this->binaryPath(key);
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) return false;
+
+  BinaryHeader header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      memcmp(header.magic, SHADER_CACHE_MAGIC, 4) != 0)
+    return false;
+
+  // Don't trust the length of a truncated or corrupt file.
+  std::error_code error;
+  const uintmax_t size = std::filesystem::file_size(path, error);
+  if (error || header.length > size - sizeof(header)) {
+    spdlog::warn("ShaderCache: Ignoring truncated binary '{}'", path);
+    return false;
+  }
+
+  std::vector<unsigned char> binary(header.length);
+  if (!in.read(reinterpret_cast<char*>(binary.data()), binary.size()))
+    return false;
+
+  return shader.loadBinary(header.format, binary.data(), binary.size());
+}
+
+void ShaderCache::saveBinary(const Shader &shader, uint64_t key) const {
+  GLenum format;
+  std::vector<unsigned char> binary;
+  if (!shader.getBinary(format, binary)) return;
+
+  std::error_code error;
+  std::filesystem::create_directories(this->directory, error);
+
+  const std::string path = this->binaryPath(key);
+  const std::string temp = path + ".tmp";
+  {
+    std::ofstream out(temp, std::ios::binary);
+    BinaryHeader header;
+    memcpy(header.magic, SHADER_CACHE_MAGIC, 4);
+    header.format = format;
+    header.length = binary.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+    if (!out.good()) {
+      spdlog::warn("ShaderCache: Failed to write '{}'", temp);
+      return;
+    }
+  }
+
+  std::filesystem::rename(temp, path, error);
+  if (error)
+    spdlog::warn("ShaderCache: Failed to write '{}': {}", path, error.message());
+}
+
+
+/*
+ ***************************************************************
+ * Loading
+ ***************************************************************
+ */
+std::shared_ptr<Shader> ShaderCache::load(const std::string &vertPath, const std::string &fragPath) {
+  ShaderSource vert {}, frag {};
+  std::shared_ptr<Shader> shader = std::make_shared<Shader>();
+  if (!readSource(vertPath, vert) || !readSource(fragPath, frag)) {
+    shader->setSources(vertPath, fragPath);
+    return shader;
+  }
+
+  // Only loose files can be edited.
+  const bool loose = vert.data == vert.storage.data() && frag.data == frag.storage.data();
+
+  // Identical sources share a program, edits to any of their files reload it.
+  const uint64_t key = sourceKey(vert, frag);
+  auto it = this->programs.find(key);
+  if (it != this->programs.end()) {
+    if (std::shared_ptr<Shader> program = it->second.lock()) {
+      if (loose) this->watchSources(program, vertPath, fragPath);
+      return program;
+    }
+  }
+  this->programs[key] = shader;
+  shader->setSources(vertPath, fragPath);
+  if (loose) this->watchSources(shader, vertPath, fragPath);
+
+  // Let the driver compile on as many threads as it likes.
+  if (!this->parallel) {
+    if (GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(SHADER_COMPILE_THREADS);
+    else if (GLEW_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(SHADER_COMPILE_THREADS);
+    this->parallel = true;
+  }
+
+  // Binaries are only valid for the driver that produced them.
+  if (this->driver.empty()) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats > 0) {
+      this->driver = std::string(reinterpret_cast<const char*>(glGetString(GL_VENDOR))) + "\n" +
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)) + "\n" +
+        reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    }
+  }
+
+  const bool persistent = !this->directory.empty() && !this->driver.empty();
+  const uint64_t binaryKey = hashBytes(key, this->driver.data(), this->driver.size());
+  if (persistent && this->loadBinary(*shader, binaryKey)) {
+    this->cached++;
+    spdlog::info("ShaderCache: Loaded ({}, {}) from its binary", vertPath, fragPath);
+    return shader;
+  }
+
+  // Missing or rejected binary, compile from the sources.
+  shader->submit(vert.data, vert.size, frag.data, frag.size);
+  this->compiled++;
+  this->pending.push_back({ shader, binaryKey, persistent });
+
+  return shader;
+}
+
+void ShaderCache::complete(const Pending &program) {
+  if (program.persistent && program.shader->ready)
+    this->saveBinary(*program.shader, program.binaryKey);
+
+  this->linked++;
+  if (this->progress) this->progress(this->linked, this->compiled);
+}
+
+void ShaderCache::watchSources(const std::shared_ptr<Shader> &shader, const std::string &vertPath, const std::string &fragPath) {
+  for (const std::string &path : { vertPath, fragPath }) {
+    const std::string file = watchKey(path);
+    std::vector<Dependent> &users = this->dependents[file];
+
+    // The same pair loaded again is already watched.
+    const bool known = std::any_of(users.begin(), users.end(), [&](const Dependent &user) {
+      return user.shader.lock() == shader && user.vertPath == vertPath && user.fragPath == fragPath;
+    });
+    if (known) continue;
+
+    users.push_back({ shader, vertPath, fragPath });
+    if (this->watcher) this->watcher->watch(file);
+  }
+}
+
+void ShaderCache::reloadChanged() {
+  std::vector<std::string> changes;
+  this->watcher->poll(changes);
+
+  // Programs using both changed files reload once, from the pair that changed.
+  std::vector<std::pair<std::shared_ptr<Shader>, Dependent>> reloads;
+  for (const std::string &path : changes) {
+    auto it = this->dependents.find(path);
+    if (it == this->dependents.end()) continue;
+
+    std::vector<Dependent> &users = it->second;
+    users.erase(std::remove_if(users.begin(), users.end(), [](const Dependent &user) {
+      return user.shader.expired();
+    }), users.end());
+
+    for (const Dependent &user : users) {
+      std::shared_ptr<Shader> program = user.shader.lock();
+      auto known = std::find_if(reloads.begin(), reloads.end(), [&](const auto &reload) {
+        return reload.first == program;
+      });
+      if (known == reloads.end()) reloads.push_back({ program, user });
+    }
+  }
+
+  for (const auto &reload : reloads) {
+    const std::shared_ptr<Shader> &program = reload.first;
+    const Dependent &user = reload.second;
+
+    ShaderSource vert {}, frag {};
+    if (!readSource(user.vertPath, vert) || !readSource(user.fragPath, frag)) continue;
+
+    spdlog::info("ShaderCache: Reloading Shader[{}]", program->ID);
+    if (!program->reloadSource(vert.data, vert.size, frag.data, frag.size)) continue;
+    program->setSources(user.vertPath, user.fragPath);
+
+    // Key the program by its new sources, so loads of the old ones compile them again.
+    for (auto it = this->programs.begin(); it != this->programs.end(); ++it) {
+      if (it->second.lock() == program) {
+        this->programs.erase(it);
+        break;
+      }
+    }
+    const uint64_t key = sourceKey(vert, frag);
+    if (this->programs[key].expired()) this->programs[key] = program;
+  }
+}
+
+void ShaderCache::update() {
+  if (this->watcher) this->reloadChanged();
+
+  // Programs already checked on first use count as done.
+  for (size_t i = 0; i < this->pending.size();) {
+    if (!this->pending[i].shader->poll()) {
+      i++;
+      continue;
+    }
+
+    this->complete(this->pending[i]);
+    this->pending[i] = std::move(this->pending.back());
+    this->pending.pop_back();
+  }
+}
+
+void ShaderCache::wait() {
+  for (const Pending &program : this->pending) {
+    program.shader->finish();
+    this->complete(program);
+  }
+  this->pending.clear();
+}
+
+void ShaderCache::setProgressCallback(ProgressCallback callback) {
+  this->progress = callback;
+}
+
+size_t ShaderCache::getPending() const {
+  return this->pending.size();
+}
+
+void ShaderCache::setLiveUpdate(bool enabled) {
+  if (!enabled) {
+    this->watcher.reset();
+    return;
+  }
+  if (this->watcher) return;
+
+  this->watcher = std::make_unique<FileWatcher>();
+  for (const auto &dependent : this->dependents)
+    this->watcher->watch(dependent.first);
+}
+
+void ShaderCache::setDirectory(const std::string &path) {
+  this->directory = path;
+}
+
+size_t ShaderCache::getCompiled() const {
+  return this->compiled;
+}
+
+size_t ShaderCache::getCached() const {
+  return this->cached;
+}
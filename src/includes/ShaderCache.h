@@ -0,0 +1,160 @@
+#pragma once
+
+// Library
+#include "Shader.h"
+#include "utils/FileWatcher.h"
+
+// Core libraries
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/* Directory program binaries are stored in, relative to the working directory */
+#define SHADER_CACHE_DIR "./.cache/shaders"
+
+/* Max number of driver threads compiling shaders, when supported */
+#define SHADER_COMPILE_THREADS 0xFFFFFFFF
+
+/* Program binary files start with these bytes */
+#define SHADER_CACHE_MAGIC "SRPB"
+
+
+/**
+ * Shared cache of linked Shader programs.
+ *  - Programs are keyed by the contents of their sources, so identical
+ *  (vertex, fragment) pairs share a single program within a process
+ *  - Linked programs are saved as driver binaries, keyed by the sources
+ *  and the driver's vendor, renderer & version. Later runs load the
+ *  binary instead of compiling, falling back to the sources when the
+ *  driver rejects it
+ *  - Sources are submitted without waiting on the driver, so programs
+ *  loaded together compile in parallel (KHR_parallel_shader_compile).
+ *  Each program is checked when first used, or as update() sees it done
+ *  - With live updates on, source files are watched with inotify off the
+ *  render thread. Programs using a changed file are reloaded by update(),
+ *  at a frame boundary, keeping the last good program on errors. Reloaded
+ *  programs are keyed by their new sources
+ *  - Handles are ref-counted, a program is freed with its last handle
+ */
+class ShaderCache {
+  private:
+    /* Header of a program binary file, followed by the binary */
+    struct BinaryHeader {
+      char magic[4];
+      uint32_t format;      // Binary Format, from glGetProgramBinary
+      uint32_t length;      // Size of the binary in bytes
+    };
+
+    /* Program submitted from sources, saved once linked */
+    struct Pending {
+      std::shared_ptr<Shader> shader;
+      uint64_t binaryKey;
+      bool persistent;      // Whether to save its binary
+    };
+
+    /* Program loaded from a pair of loose source files */
+    struct Dependent {
+      std::weak_ptr<Shader> shader;
+      std::string vertPath, fragPath;
+    };
+
+  public:
+    /**
+     * Called as submitted programs finish linking.
+     *	@param linked - Programs linked so far
+     *	@param total - Programs submitted so far
+     */
+    typedef std::function<void(size_t linked, size_t total)> ProgressCallback;
+
+  private:
+    std::unordered_map<uint64_t, std::weak_ptr<Shader>> programs;
+    std::vector<Pending> pending;
+    ProgressCallback progress;
+    bool parallel;          // Whether the driver thread count was set
+
+    // Programs using each loose source file, for live updates.
+    std::unordered_map<std::string, std::vector<Dependent>> dependents;
+    std::unique_ptr<FileWatcher> watcher;
+    std::string directory;
+    std::string driver;     // Vendor, renderer & version of the context
+    size_t compiled;        // Programs compiled from sources
+    size_t cached;          // Programs loaded from binaries
+    size_t linked;          // Submitted programs done linking
+
+  private:
+    ShaderCache();
+
+    /* Returns the binary file of the given key */
+    std::string binaryPath(uint64_t key) const;
+
+    /* Loads the program's binary, returns false if missing or rejected */
+    bool loadBinary(Shader &shader, uint64_t key) const;
+
+    /* Saves the program's binary, for later runs */
+    void saveBinary(const Shader &shader, uint64_t key) const;
+
+    /* Saves & reports a program done linking */
+    void complete(const Pending &program);
+
+    /* Watches the source files a program was loaded from, for live updates */
+    void watchSources(const std::shared_ptr<Shader> &shader, const std::string &vertPath, const std::string &fragPath);
+
+    /* Reloads the programs using the source files changed since last frame */
+    void reloadChanged();
+
+  public:
+    /* Returns the cache shared by all Shapes */
+    static ShaderCache& get();
+
+    /**
+     * Returns the program of the given sources, loading it on first use.
+     *  Must be called on the GL thread, returns without waiting for the
+     *  link. Sources are read from the mounted AssetPack first, then the
+     *  filesystem.
+     *	@param vertPath - Vertex Shader Source path
+     *	@param fragPath - Fragment Shader Source path
+     */
+    std::shared_ptr<Shader> load(const std::string &vertPath, const std::string &fragPath);
+
+    /**
+     * Called once per frame on the GL thread. Checks the submitted programs
+     *  that finished linking, without blocking on the others, & reloads the
+     *  programs whose sources changed.
+     */
+    void update();
+
+    /* Blocks until every submitted program is linked & checked */
+    void wait();
+
+    /**
+     * Sets the function called as submitted programs finish linking.
+     *	@param callback - Progress callback, nullptr to remove
+     */
+    void setProgressCallback(ProgressCallback callback);
+
+    /* Returns the number of submitted programs still linking */
+    size_t getPending() const;
+
+    /**
+     * Turns live updates of loose source files on or off.
+     *	@param enabled - Whether to watch & reload sources
+     */
+    void setLiveUpdate(bool enabled);
+
+    /**
+     * Sets the directory binaries are stored in, empty to disable the
+     *  on-disk cache.
+     *	@param path - Cache directory, SHADER_CACHE_DIR by default
+     */
+    void setDirectory(const std::string &path);
+
+    /* Returns the number of programs compiled from sources */
+    size_t getCompiled() const;
+
+    /* Returns the number of programs loaded from cached binaries */
+    size_t getCached() const;
+};
@@ -1,4 +1,5 @@
 #include "SimpleRender.h"
+#include "GLState.h"
 
 /**
  ***********************************************************
@@ -100,6 +101,29 @@ const double SimpleRender::getFPS() {
   return FPS;
 }
 
+glm::ivec2 SimpleRender::getResolution() {
+  if (this->headless)
+    return glm::ivec2(this->framebuffer.getWidth(), this->framebuffer.getHeight());
+
+  int width, height;
+  glfwGetWindowSize(this->getWindow(), &width, &height);
+  return glm::ivec2(width, height);
+}
+
+double SimpleRender::getTime() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
+}
+
+glm::mat4 SimpleRender::getViewTransform() {
+  return glm::mat4(1.0f);
+}
+
+void SimpleRender::prepareBatch(Shader *shader, Texture *texture) {}
+
+void SimpleRender::submit(Shape *shape) {
+  renderQueue.submit(shape);
+}
+
 
 /**
  ***********************************************************
@@ -116,59 +140,51 @@ const double SimpleRender::getFPS() {
  ***********************************************************
  */
 
-void SimpleRender::Draw() {
-  // Output FPS to Window Title
-  sprintf(titleBuffer, "%s [%.2f FPS]", title, getFPS());
-  glfwSetWindowTitle(window, titleBuffer);
+void SimpleRender::updateFrameUniforms() {
+  FrameData frame {};
+  frame.transform = getViewTransform();
 
+  // Set Resolution Vector
+  const glm::ivec2 resolution = this->getResolution();
+  frame.u_res = glm::vec2(resolution.x, resolution.y);
 
-  // Render all Buffer Data
-  for (BufferData &bd : bufferData) {
-    // Activate the bound shader program.
-    bd.shader->use();
-
-    /* Update Uniform values */
-    {
-      GLint u_time = glGetUniformLocation(bd.shader->ID, "u_time");
-      GLint u_mouse = glGetUniformLocation(bd.shader->ID, "u_mouse");
-      GLint u_res = glGetUniformLocation(bd.shader->ID, "u_res");
+  frame.u_mouse = this->getMousePos();
+  frame.u_time = this->getTime();
 
-      // Update Uniform Data
-      glUniform1f(u_time, glfwGetTime());
+  frameUniforms.update(&frame);
+}
 
-      // Set Resolution Vector
-      int width, height;
-      glfwGetWindowSize(this->getWindow(), &width, &height);
-      glm::vec2 v_res(width, height);
-      glUniform2fv(u_res, 1, glm::value_ptr(v_res));  // A Single vec2 Float
+void SimpleRender::flushRenderQueue() {
+  {
+    PROFILE_SCOPE("Sort");
+    renderQueue.sort();
+  }
 
-      // Mouse position.
-      glUniform2fv(u_mouse, 1, glm::value_ptr(this->getMousePos()));
-    }
+  // Sorted draws sharing state are merged into the same batch.
+  for (const RenderItem &item : renderQueue.getItems())
+    batchRenderer.submit(item.shape);
 
-    // Enable aPos Attribute
-    glEnableVertexAttribArray(0);
+  batchRenderer.flush([this](Shader *shader, Texture *texture) {
+    this->prepareBatch(shader, texture);
+  });
+  renderQueue.clear();
+}
 
-    // Bind Vertex Array Object
-    glBindVertexArray(bd.VAO);
+void SimpleRender::Draw() {
+  // Render all Buffer Data
+  for (BufferData &bd : bufferData) {
+    // Activate the bound shader program.
+    // Time, Mouse & Resolution uniforms come from the FrameData block.
+    bd.shader->use();
 
-    // Bind Indicies
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd.indiciesBuffer);
+    // Bind Vertex Array Object, which holds the attributes & index buffer.
+    GLState::bindVertexArray(bd.VAO);
 
     // Bind the Texture
     if (bd.texture) bd.texture->bind(0);
 
     // Draw the Elements
     glDrawElements(GL_TRIANGLES, bd.indiciesElts, GL_UNSIGNED_INT, nullptr);
-
-    // Unbind the Texture
-    if (bd.texture) bd.texture->unbind();
-
-    // Finished with aPos Attribute
-    glDisableVertexAttribArray(0);
-
-    // Deactivate shader program.
-    glUseProgram(0);
   }
 }
 
@@ -178,12 +194,12 @@ void SimpleRender::Preload() {
   shader->compile("Shaders/shader.vert", "Shaders/shader.frag");
 
   // Create Object1
-  GLdouble verticies[] = {
-    // Positions<vec3>		RGBA<vec4>					// Texture Coordinates<vec2>
-    -0.4f, -0.2f, 0.0f,   1.0f, 0.0f, 0.0f, 1.0f,   0.0f, 0.0f,
-    -0.2f, -0.2f, 0.0f,   0.0f, 1.0f, 0.0f, 1.0f,   1.0f, 0.0f,
-    -0.4f, 0.2f, 0.0f,  0.0f, 0.0f, 1.0f, 1.0f,   0.0f, 1.0f,
-    -0.2f, 0.2f, 0.0f,  1.0f, 1.0f, 1.0f, 1.0f,   1.0f, 1.0f,
+  Vertex verticies[] = {
+    // Positions<vec3>		RGBA<4 x ubyte>					// Texture Coordinates<vec2>
+    { -0.4f, -0.2f, 0.0f,   255, 0,   0,   255,   0.0f, 0.0f },
+    { -0.2f, -0.2f, 0.0f,   0,   255, 0,   255,   1.0f, 0.0f },
+    { -0.4f, 0.2f, 0.0f,    0,   0,   255, 255,   0.0f, 1.0f },
+    { -0.2f, 0.2f, 0.0f,    255, 255, 255, 255,   1.0f, 1.0f },
   };
 
   GLuint indicies[] = {
@@ -198,12 +214,12 @@ void SimpleRender::Preload() {
 
 
   // Create Object2
-  GLdouble verticies2[] = {
-    // Positions<vec3>		RGB<vec4>					// Texture Coordinates<vec2>
-    0.0f, 0.3f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,   // Bottom-Left
-    0.4f, 0.3f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f,   // Bottom-Right
-    0.0f, -0.3f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f,  // Top-Left
-    0.4f, -0.3f, 0.0f, 0.5f, 0.0f, 0.5f, 1.0f, 1.0f, 1.0f,  // Top-Right
+  Vertex verticies2[] = {
+    // Positions<vec3>		RGBA<4 x ubyte>					// Texture Coordinates<vec2>
+    { 0.0f, 0.3f, 0.0f,   0,   255, 0,   255,   0.0f, 0.0f },   // Bottom-Left
+    { 0.4f, 0.3f, 0.0f,   0,   255, 0,   255,   1.0f, 0.0f },   // Bottom-Right
+    { 0.0f, -0.3f, 0.0f,  255, 255, 255, 255,   0.0f, 1.0f },   // Top-Left
+    { 0.4f, -0.3f, 0.0f,  128, 0,   128, 255,   1.0f, 1.0f },   // Top-Right
   };
   bufferData.push_back(
     CreateBuffer::static_float(verticies2, sizeof(verticies2), indicies, sizeof(indicies), shader)
@@ -245,7 +261,14 @@ void SimpleRender::drawImGui() {
  ***********************************************************
  */
 
-SimpleRender::SimpleRender(unsigned int w, unsigned int h, const char *title) : WIDTH(w), HEIGHT(h), bufferData({}) {
+SimpleRender::SimpleRender(unsigned int w, unsigned int h, const char *title) :
+  WIDTH(w),
+  HEIGHT(h),
+  FPS(0.0),
+  stopRequested(false),
+  window(nullptr),
+  bufferData({}),
+  frameUniforms(FRAME_DATA_BINDING, sizeof(FrameData)) {
   this->title = title;
   InitRender();
 }
@@ -254,19 +277,31 @@ SimpleRender::~SimpleRender() {
   spdlog::info("Exiting, cleaning up first...");
 
   // Cleanup ImGui
-  ImGui_ImplOpenGL3_Shutdown();
-  ImGui_ImplGlfw_Shutdown();
-  ImGui::DestroyContext();
+  if (!this->headless) {
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+  }
 
 
   /* Free Up Buffer Data */
   for (BufferData &bf : bufferData) {
     BufferData::freeBufferData(&bf);
   }
+  batchRenderer.destroy();
+  frameUniforms.destroy();
+  frameCapture.destroy();
+  TextureCache::get().destroy();
+  Profiler::get().destroy();
 
   /* Destroy Resources */
-  glfwDestroyWindow(window);
-  glfwTerminate();
+  if (this->headless) {
+    framebuffer.destroy();
+    headlessContext.destroy();
+  } else {
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  }
 }
 
 void SimpleRender::InitRender() {
@@ -278,9 +313,14 @@ void SimpleRender::InitRender() {
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // OpenGL Profile used
 }
 
-int SimpleRender::run() {
+int SimpleRender::createContext() {
+  /* Create an offscreen EGL Context, no Display needed */
+  if (this->headless) {
+    if (!headlessContext.init()) return -1;
+    return 0;
+  }
+
   /* Initialize GLFW */
-  glewExperimental = true;  // Needed for Core Profile
   if (!glfwInit()) {
     spdlog::error("Failed to Initialize GLFW");
     glfwTerminate();
@@ -302,89 +342,230 @@ int SimpleRender::run() {
 
   /* Setup GLFW Properties */
   glfwSwapInterval(1);  // Default is 0, this is to prevent Tearing
+  return 0;
+}
+
+bool SimpleRender::shouldClose() {
+  if (this->stopRequested) return true;
+  if (this->headless) return this->frameLimit && this->frameCount >= this->frameLimit;
+  return glfwWindowShouldClose(window);
+}
+
+int SimpleRender::run() {
+  this->startTime = std::chrono::steady_clock::now();
+  this->frameCount = 0;
+
+  /* Create the OpenGL Context, through a Window or offscreen */
+  glewExperimental = true;  // Needed for Core Profile
+  if (createContext() != 0) return -1;
   glEnable(GL_DEPTH_TEST);
 
 
   /* Initialize GLEW */
-  if (glewInit() != GLEW_OK) {
+  // GLEW built for GLX fails to find an X Display when headless, GL
+  // entry points are loaded prior to that so the error is harmless.
+  const GLenum glewStatus = glewInit();
+  if (glewStatus != GLEW_OK && !(this->headless && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)) {
     spdlog::error("Failed to Initalize GLEW");
-    glfwTerminate();
+    if (!this->headless) glfwTerminate();
     return -1;
   }
 
-  /* Setup Input Callbacks */
-  glfwSetWindowUserPointer(window, this);  // Keep track of Current Object
-  glfwSetKeyCallback(window, key_callback);
-  glfwSetMouseButtonCallback(window, mouseBtn_callback);
-  glfwSetCursorPosCallback(window, cursorPos_callback);
-  glfwSetScrollCallback(window, mouseScroll_callback);
-  glfwSetWindowSizeCallback(window, windowResize_callback);
-  glfwSetErrorCallback(error_callback);
-
-
-  /* Setup ImGui */
-  IMGUI_CHECKVERSION();
-  ImGui::CreateContext();
-  ImGuiIO &io = ImGui::GetIO();
-  (void)io;
-  ImGui::StyleColorsDark();
-
-  ImGui_ImplGlfw_InitForOpenGL(window, true);
-  ImGui_ImplOpenGL3_Init("#version 150");  // GLSL 3.2+
+  if (this->headless) {
+    /* Render into an offscreen Framebuffer */
+    if (!framebuffer.init(WIDTH, HEIGHT)) return -1;
+    framebuffer.bind();
+  } else {
+    /* Setup Input Callbacks */
+    glfwSetWindowUserPointer(window, this);  // Keep track of Current Object
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetMouseButtonCallback(window, mouseBtn_callback);
+    glfwSetCursorPosCallback(window, cursorPos_callback);
+    glfwSetScrollCallback(window, mouseScroll_callback);
+    glfwSetWindowSizeCallback(window, windowResize_callback);
+    glfwSetErrorCallback(error_callback);
+
+
+    /* Setup ImGui */
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO &io = ImGui::GetIO();
+    (void)io;
+    ImGui::StyleColorsDark();
+
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 150");  // GLSL 3.2+
+  }
 
   const char* opengl_version = (const char*)(glGetString(GL_VERSION));
   if (opengl_version) spdlog::info("Using OpenGL Version: {}", opengl_version);
 
-  /* Keep track of FPS & Fixed Upate */
-  double lastTime = glfwGetTime();
-  int frameCount = 0;
+  /* Setup the Batch Renderer's streaming buffers & per-frame globals */
+  batchRenderer.init();
+  frameUniforms.init();
+  frameCapture.init();
+
+  /* Keep track of Frame Times & Fixed Upate */
+  double lastTime = getTime();
+  double lastSummary = lastTime;
+  double frameStart = lastTime;
 
   /* Run Pre-Start Function */
   Preload();
 
-  /* Keep Window open until 'Q' key is pressed */
-  glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
+  /* Headless frames are captured as-is, so don't render placeholders,
+   *  windowed runs check programs as they're first used */
+  if (this->headless) {
+    TextureCache::get().wait();
+    ShaderCache::get().wait();
+  }
+
+  /* Keep Window open until 'Q' key is pressed, or the frame limit is reached */
+  if (!this->headless) glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
   do {
-    // Measure the Speed (FPS)
-    double currentTime = glfwGetTime();
-    frameCount++;
+    // Measure the time between frames
+    double currentTime = getTime();
+    const double frameTime = currentTime - frameStart;
+    frameStart = currentTime;
     if (currentTime - lastTime >= 1.0) {
       fixedUpdate(currentTime - lastTime);
-      FPS = frameCount;
-      frameCount = 0;
       lastTime += 1.0;
     }
 
+    // Summarize the recent frames periodically, not every frame
+    if (currentTime - lastSummary >= FRAME_STATS_INTERVAL) {
+      FPS = frameStats.update().fps;
+      lastSummary = currentTime;
+
+      if (!this->headless) {
+        const FrameSummary &stats = frameStats.getSummary();
+        snprintf(titleBuffer, sizeof(titleBuffer), "%s [%.1f FPS | p99 %.2f ms]", title, stats.fps, stats.p99);
+        glfwSetWindowTitle(window, titleBuffer);
+      }
+    }
+
+    // Profile the frame, up to the buffer swap
+    Profiler::get().beginFrame();
+    Profiler::get().pushGpu("Frame");
+
     // Start ImGui Frame
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
-    ImGui::NewFrame();
+    if (!this->headless) {
+      ImGui_ImplOpenGL3_NewFrame();
+      ImGui_ImplGlfw_NewFrame();
+      ImGui::NewFrame();
+    }
 
 
     // Clear the Screen
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // Setup ImGui
-    drawImGui();
+    if (!this->headless) {
+      PROFILE_SCOPE("Debug UI");
+      drawImGui();
+    }
+
+    // Upload the textures decoded since last frame & check finished links
+    {
+      PROFILE_SCOPE("Caches");
+      TextureCache::get().update();
+      ShaderCache::get().update();
+    }
 
     // Draw here...
-    Draw();
+    {
+      PROFILE_SCOPE("Draw");
+      updateFrameUniforms();
+      Draw();
+    }
+    {
+      PROFILE_SCOPE("Flush");
+      PROFILE_GPU_SCOPE("Flush");
+      flushRenderQueue();
+    }
 
-    // Render ImGui
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    // Capture the frame, prior to the ImGui overlay
+    {
+      PROFILE_SCOPE("Capture");
+      const glm::ivec2 resolution = getResolution();
+      frameCapture.capture(this->headless ? framebuffer.getID() : 0, resolution.x, resolution.y);
+
+      // Requested by readPixels(), while the back buffer holds the frame.
+      if (this->readback) {
+        std::vector<GLubyte> &rgba = *this->readback;
+        rgba.resize((size_t)resolution.x * resolution.y * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glReadBuffer(GL_BACK);
+        glReadPixels(0, 0, resolution.x, resolution.y, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        this->readback = nullptr;
+      }
+    }
 
-    // Swap Buffers
-    glfwSwapBuffers(window);
+    // Render ImGui
+    if (!this->headless) {
+      PROFILE_SCOPE("ImGui");
+      PROFILE_GPU_SCOPE("ImGui");
+      ImGui::Render();
+      ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+      // ImGui binds its own objects behind GLState's back.
+      GLState::invalidate();
+    }
+    GLState::endFrame();
+    Profiler::get().popGpu();
+    this->frameCount++;
+
+    // CPU time excludes waiting on the swap, GPU times arrive a few frames late
+    const double cpuTime = getTime() - frameStart;
+    if (this->frameCount > 1) {
+      frameStats.record({
+        (float)(frameTime * 1e3),
+        (float)(cpuTime * 1e3),
+        (float)(Profiler::get().getGpuFrameTime() * 1e3)
+      });
+    }
 
-    // Wait for Polling Events
-    glfwPollEvents();
-  } while (!glfwWindowShouldClose(window));  // Keep Window Open util Window should Closed
+    // Swap Buffers & Wait for Polling Events
+    if (!this->headless) {
+      PROFILE_SCOPE("Swap");
+      glfwSwapBuffers(window);
+      glfwPollEvents();
+    }
+    Profiler::get().endFrame();
+  } while (!shouldClose());  // Keep Window Open util Window should Closed
 
   // No Issues
   return 0;
 }
 
+void SimpleRender::setHeadless(size_t frames) {
+  this->headless = true;
+  this->frameLimit = frames;
+}
+
+bool SimpleRender::isHeadless() const {
+  return this->headless;
+}
+
+void SimpleRender::stop() {
+  this->stopRequested = true;
+}
+
+size_t SimpleRender::getFrameCount() const {
+  return this->frameCount;
+}
+
+void SimpleRender::readPixels(std::vector<GLubyte> &rgba) {
+  if (this->headless) {
+    framebuffer.read(rgba);
+    return;
+  }
+
+  // Read the back buffer before it's swapped, its contents are undefined after.
+  this->readback = &rgba;
+}
+
 GLFWwindow* SimpleRender::getWindow() {
   return this->window;
 }
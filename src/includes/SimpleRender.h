@@ -5,6 +5,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <fstream>
 #include <memory>
@@ -24,8 +26,18 @@
 #include <glm/vec3.hpp>
 
 // Project Libraries
+#include "BatchRenderer.h"
 #include "BufferData.h"
+#include "FrameCapture.h"
+#include "FrameStats.h"
+#include "Framebuffer.h"
+#include "HeadlessContext.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "TextureCache.h"
+#include "UniformBuffer.h"
 
 
 
@@ -33,9 +45,19 @@ class SimpleRender {
   private:  // Private Variables | GL Window Data
     unsigned int WIDTH = 400;
     unsigned int HEIGHT = 400;
-    double FPS;      // Current Calculated FPS Value
+    double FPS;      // Mean FPS of the last FrameStats summary
     glm::vec2 mousePos;  // Current Mouse Position
 
+  private:  // Private Variables | Headless Rendering
+    bool headless = false;                // Render offscreen, without a window
+    size_t frameLimit = 0;                // Frames to render when headless, 0 until stopped
+    size_t frameCount = 0;                // Frames rendered since run() started
+    std::atomic<bool> stopRequested;      // Set by stop(), from any thread
+    HeadlessContext headlessContext;      // EGL Context used when headless
+    Framebuffer framebuffer;              // Render target used when headless
+    std::vector<GLubyte> *readback = nullptr;  // Filled from the back buffer before the swap, see readPixels()
+    std::chrono::steady_clock::time_point startTime;
+
 
   protected:  // Shared Window Data
     GLFWwindow* window;
@@ -45,6 +67,11 @@ class SimpleRender {
 
   protected:  // Shared Variables
     std::vector<BufferData> bufferData;  // Store References the Buffer Data
+    BatchRenderer batchRenderer;         // Batches Shapes into as few draw calls as possible
+    RenderQueue renderQueue;             // Sorts submitted Shapes by state before batching
+    UniformBuffer frameUniforms;         // Per-frame globals shared by all programs (FrameData)
+    FrameCapture frameCapture;           // Asynchronous screenshots & video recording
+    FrameStats frameStats;               // Frame time distribution, summarized periodically
 
   private:  // Private Methods (Static - Callbacks)
     /* Called when Key Pressed */
@@ -76,14 +103,72 @@ class SimpleRender {
 
   protected:  // Shared Methods
     /**
-     * Returns the Calculated Frames Per Second from Draw Loop
+     * Returns the mean Frames Per Second of the recent frames, updated
+     *  every FRAME_STATS_INTERVAL seconds
      *	@returns FPS Value
     */
     const double getFPS();
 
+    /**
+     * Returns the size of the render target, the window's or the
+     *  offscreen framebuffer's when headless.
+     */
+    glm::ivec2 getResolution();
+
+    /**
+     * Returns the time in seconds since run() started. Doesn't
+     *  depend on GLFW, so that it's available when headless.
+     */
+    double getTime();
+
+
+
+  protected:  // Shared Overrideable Properties
+    /**
+     * Returns the view transform applied to all programs,
+     *  through the FrameData uniform block.
+     */
+    virtual glm::mat4 getViewTransform();
+
+    /**
+     * Called once per batch when flushing the Render Queue, after the
+     *  shader is in use and the texture is bound.
+     *	@param shader - Shader of the batch
+     *	@param texture - Texture of the batch, nullptr if none
+     */
+    virtual void prepareBatch(Shader* shader, Texture* texture);
+
+
+  protected:  // Shared Methods (Rendering)
+    /**
+     * Queues a Shape to be drawn at the end of the frame, sorted by
+     *  layer & GPU state.
+     */
+    void submit(Shape* shape);
 
 
   private:  // Helper Functions
+    /**
+     * Creates the OpenGL Context & makes it current, through a
+     *  GLFW Window or an EGL Context when headless
+     *	@returns 0 on success, -1 otherwise
+     */
+    int createContext();
+
+    /**
+     * Whether the Draw Loop should end
+     */
+    bool shouldClose();
+    /**
+     * Updates the per-frame globals, once prior to Drawing
+     */
+    void updateFrameUniforms();
+
+    /**
+     * Sorts & Draws the submitted Shapes, after Drawing
+     */
+    void flushRenderQueue();
+
     /**
      * Draw loop
      */
@@ -136,6 +221,32 @@ class SimpleRender {
       */
     const glm::vec2 getMousePos();
 
+    /**
+     * Renders offscreen through an EGL context instead of a window, with
+     *  no vsync & no ImGui. Must be called prior to run().
+     *	@param frames - Number of frames to render, 0 renders until stop()
+     */
+    void setHeadless(size_t frames = 0);
+
+    /* Returns whether rendering offscreen */
+    bool isHeadless() const;
+
+    /* Requests run() to return after the current frame. Thread-safe. */
+    void stop();
+
+    /* Returns the number of frames rendered since run() started */
+    size_t getFrameCount() const;
+
+    /**
+     * Reads back a rendered frame as RGBA, bottom row first.
+     *  - Headless: reads the last frame, from the render thread or after run()
+     *  - Windowed: the back buffer is undefined once swapped, so the current
+     *  frame is read prior to the ImGui overlay & swap. Call from the render
+     *  thread during a frame (e.g. Draw), rgba is filled before it ends.
+     *	@param rgba - Resized to width * height * 4 bytes
+     */
+    void readPixels(std::vector<GLubyte> &rgba);
+
 
     /**
      * Starts running OpenGL window
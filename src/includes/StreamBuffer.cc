@@ -0,0 +1,173 @@
+#include "StreamBuffer.h"
+#include "GLState.h"
+
+#include <spdlog/spdlog.h>
+
+
+/*
+ ***************************************************************
+ * Constructors & GL Resources
+ *	- Constructor
+ *		- Configures the target & region size
+ *	- Initialize, Destroy & Resize the buffer
+ ***************************************************************
+ */
+StreamBuffer::StreamBuffer(GLenum target, size_t regionSize) :
+  ID(0),
+  target(target),
+  regionSize(regionSize),
+  head(0),
+  region(0),
+  persistent(false),
+  mapped(nullptr),
+  fences() {}
+
+size_t StreamBuffer::capacity() const {
+  return this->regionSize * STREAM_BUFFER_REGIONS;
+}
+
+void StreamBuffer::init() {
+  glGenBuffers(1, &this->ID);
+  GLState::bindBuffer(this->target, this->ID);
+  this->head = 0;
+  this->region = 0;
+
+  this->persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+  if (this->persistent) {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(this->target, this->capacity(), nullptr, flags);
+    this->mapped = (GLubyte*)glMapBufferRange(this->target, 0, this->capacity(), flags);
+
+    if (!this->mapped) {
+      spdlog::warn("StreamBuffer: Failed to persistently map buffer, falling back to orphaning");
+      GLState::deleteBuffer(this->ID);
+      glGenBuffers(1, &this->ID);
+      GLState::bindBuffer(this->target, this->ID);
+      this->persistent = false;
+    }
+  }
+
+  if (!this->persistent)
+    glBufferData(this->target, this->capacity(), nullptr, GL_STREAM_DRAW);
+}
+
+void StreamBuffer::destroy() {
+  if (!this->ID) return;
+
+  for (size_t region = 0; region < STREAM_BUFFER_REGIONS; region++)
+    this->waitRegion(region);
+
+  if (this->mapped) {
+    GLState::bindBuffer(this->target, this->ID);
+    glUnmapBuffer(this->target);
+    this->mapped = nullptr;
+  }
+
+  GLState::deleteBuffer(this->ID);
+  this->ID = 0;
+}
+
+void StreamBuffer::reserve(size_t regionSize) {
+  if (regionSize <= this->regionSize) return;
+
+  spdlog::warn("StreamBuffer: Growing region size to {} bytes", regionSize);
+  this->destroy();
+  this->regionSize = regionSize;
+  this->init();
+}
+
+
+/*
+ ***************************************************************
+ * Region Synchronization
+ *	- Fence a region once the CPU moves past it
+ *	- Wait on a region once the CPU wraps around to it
+ ***************************************************************
+ */
+void StreamBuffer::fenceRegion(size_t region) {
+  if (this->fences[region]) glDeleteSync(this->fences[region]);
+  this->fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamBuffer::waitRegion(size_t region) {
+  GLsync fence = this->fences[region];
+  if (!fence) return;
+
+  // Flush on the first wait, so the fence is guaranteed to signal.
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  while (true) {
+    GLenum status = glClientWaitSync(fence, flags, 1000000);   // 1ms
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) break;
+    if (status == GL_WAIT_FAILED) {
+      spdlog::error("StreamBuffer: Failed waiting on region {}", region);
+      break;
+    }
+    flags = 0;
+  }
+
+  glDeleteSync(fence);
+  this->fences[region] = nullptr;
+}
+
+
+/*
+ ***************************************************************
+ * Mapping
+ *	- Reserves space in the ring, moving on to the next region
+ *	when the current one can't hold the write
+ ***************************************************************
+ */
+void* StreamBuffer::map(size_t size, size_t alignment, size_t &offset) {
+  if (size > this->regionSize) {
+    spdlog::error("StreamBuffer: Write of {} bytes exceeds the region size of {} bytes", size, this->regionSize);
+    return nullptr;
+  }
+
+  size_t start = ((this->head + alignment - 1) / alignment) * alignment;
+  bool invalidate = false;
+
+  // Doesn't fit in the current region, move on to the start of the next one.
+  if (start + size > (this->region + 1) * this->regionSize) {
+    const size_t next = (this->region + 1) % STREAM_BUFFER_REGIONS;
+
+    if (this->persistent) {
+      this->fenceRegion(this->region);
+      this->waitRegion(next);
+    }
+
+    // Wrapped around, the whole buffer can be orphaned.
+    invalidate = next == 0;
+    start = next * this->regionSize;
+    this->region = next;
+  }
+
+  offset = start;
+  this->head = start + size;
+  GLState::countUpload(size);
+
+  if (this->persistent)
+    return this->mapped + start;
+
+  // Fallback: Orphan the buffer when wrapping, otherwise append without syncing.
+  GLState::bindBuffer(this->target, this->ID);
+  GLbitfield flags = GL_MAP_WRITE_BIT;
+  flags |= invalidate
+    ? GL_MAP_INVALIDATE_BUFFER_BIT
+    : GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+  return glMapBufferRange(this->target, start, size, flags);
+}
+
+void StreamBuffer::unmap() {
+  if (this->persistent) return;
+
+  GLState::bindBuffer(this->target, this->ID);
+  glUnmapBuffer(this->target);
+}
+
+GLuint StreamBuffer::getID() const {
+  return this->ID;
+}
+
+bool StreamBuffer::isPersistent() const {
+  return this->persistent;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+// Core libraries
+#include <GL/glew.h>
+#include <stddef.h>
+
+
+/* Number of regions the stream buffer is split into */
+#define STREAM_BUFFER_REGIONS 3
+
+/**
+ * Streaming upload buffer, written directly by the CPU.
+ *
+ * When buffer storage is available (GL 4.4 / ARB_buffer_storage), the
+ *  buffer is persistently & coherently mapped and split into triple
+ *  buffered regions. Each region is fenced once the CPU moves past it,
+ *  and only waited on when the ring wraps back around to it, so writes
+ *  never implicitly sync with the GPU.
+ *
+ * Otherwise, falls back to mapping unsynchronized ranges and orphaning
+ *  the buffer whenever it fills up.
+ */
+class StreamBuffer {
+  private:
+    GLuint ID;                                // Buffer Object
+    GLenum target;                            // Buffer target (GL_ARRAY_BUFFER, ...)
+    size_t regionSize;                        // Size of a single region in bytes
+    size_t head;                              // Next write offset in bytes
+    size_t region;                            // Region currently written into
+    bool persistent;                          // Persistently mapped or falling back to orphaning
+    GLubyte *mapped;                          // Persistently mapped memory
+    GLsync fences[STREAM_BUFFER_REGIONS];     // Fence per region, placed once the CPU moves on
+
+  private:
+    /* Total size of the buffer in bytes */
+    size_t capacity() const;
+
+    /* Fences the region, marking the end of the GPU's use of it */
+    void fenceRegion(size_t region);
+
+    /* Waits for the GPU to be done with the region */
+    void waitRegion(size_t region);
+
+  public:
+    /**
+     * Constructs the Stream Buffer. GL Objects are created on init().
+     *	@param target - Buffer target the buffer is used as
+     *	@param regionSize - Size of a single region in bytes
+     */
+    StreamBuffer(GLenum target, size_t regionSize);
+
+    /* Creates & maps the buffer. Requires a current GL Context */
+    void init();
+
+    /* Releases the GL Objects, waiting on the GPU. Requires a current GL Context */
+    void destroy();
+
+    /* Recreates the buffer with larger regions, if needed */
+    void reserve(size_t regionSize);
+
+    /**
+     * Reserves space to write into, not exceeding the region size.
+     *	@param size - Size in bytes to write
+     *	@param alignment - Alignment in bytes of the returned offset
+     *	@param offset - Set to the offset of the space in the buffer
+     *	@return Pointer to write the data into
+     */
+    void* map(size_t size, size_t alignment, size_t &offset);
+
+    /* Finishes writing into the last mapped space */
+    void unmap();
+
+    /* Returns the Buffer Object */
+    GLuint getID() const;
+
+    /* Returns whether the buffer is persistently mapped */
+    bool isPersistent() const;
+};
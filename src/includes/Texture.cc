@@ -1,6 +1,10 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image/stb_image.h>
 #include "Texture.h"
+#include "GLState.h"
+#include "AssetPack.h"
+
+#include <spdlog/spdlog.h>
 
 /*
  ***************************************************************
@@ -8,6 +12,8 @@
  *	- Default Constructor
  *		- Initializes everything to their default values
  *	- Construct Texture based on Image Source Given
+ *	- Construct Texture from RGBA Pixels in Memory
+ *	- Construct Texture from a Compressed Image
  *
  *	- Destructor used to Free up Memory
  *
@@ -17,59 +23,72 @@
 Texture::Texture() {
 	width = height = channels = 0;
 	textureID = 0;
+	flipY = false;
 }
 
 Texture::Texture(const char* src) {
+	width = height = channels = 0;
+	textureID = 0;
+	flipY = TextureFile::is_compressed(src);
+
+	// Packed Textures are read from the mapped pack, no file I/O
+	Asset asset;
+	const bool packed = AssetPack::get().find(src, asset);
+
+	// Pre-baked Compressed Textures skip decoding & Mipmap generation
+	if (TextureFile::is_compressed(src)) {
+		CompressedImage image;
+		const bool loaded = packed
+			? TextureFile::parse(asset.data, asset.size, image)	// Levels point into the pack
+			: TextureFile::load(src, image);
+		if (!loaded) {
+			spdlog::error("Texture: '{}' not Loaded in Properly!", src);
+			return;
+		}
+
+		// Uploaded top row first, as stored (see flipY)
+		upload(image);
+		return;
+	}
+
 	// Setup STBI Settings
 	stbi_set_flip_vertically_on_load(true);	// Flip Images Vertically
 
 	// Load in the Image (RGBA Channels)
-	unsigned char *data = stbi_load(src, &width, &height, &channels, 4);
-
-	// Make sure data is Loaded Successfully
-	if (data) {
-		// Generate and Bind Texture
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-
-		// Setup Texture Properties to Bound Texture
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-
-		// Specify & Load Data of Image Texture
-		glTexImage2D(
-			GL_TEXTURE_2D,
-			0,
-			GL_RGBA8,			// 8-bits (1Byte) per channel (0-255)
-			width,
-			height,
-			0,
-			GL_RGBA,
-			GL_UNSIGNED_BYTE,
-			data
-		);
-
-		// Generate a Mipmap for the Texture
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
+	int w, h;
+	unsigned char *data = packed
+		? stbi_load_from_memory(asset.data, asset.size, &w, &h, &channels, 4)
+		: stbi_load(src, &w, &h, &channels, 4);
 
 	// ERROR: Texture not Loaded
-	else {
-		textureID = 0;
+	if (!data) {
 		std::cerr << "Texture: Image not Loaded in Properly!\n";
 		return;
 	}
 
+	upload(w, h, data);
+
 	// Free up Image Data
 	stbi_image_free(data);
 }
 
+Texture::Texture(int width, int height, const void* pixels) {
+	this->width = this->height = 0;
+	channels = 4;
+	textureID = 0;
+	flipY = false;
+	upload(width, height, pixels);
+}
+
+Texture::Texture(const CompressedImage& image) {
+	width = height = channels = 0;
+	textureID = 0;
+	flipY = true;
+	upload(image);
+}
+
 Texture::~Texture() {
-	glDeleteTextures(1, &textureID);
+	GLState::deleteTexture(textureID);
 }
 
 
@@ -77,14 +96,91 @@ Texture::~Texture() {
  ***************************************************************
  * Texture Handling and Manipulation
  *	- Bind & Unbind Current Texture
+ *	- Upload the Texture Image
  ***************************************************************
  */
 
 void Texture::bind(unsigned int slot = 0) {
-	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::bindTexture(slot, GL_TEXTURE_2D, textureID);
 }
 
 void Texture::unbind() {
-	glBindTexture(GL_TEXTURE_2D, 0);
-}
\ No newline at end of file
+	GLState::bindTexture(0, GL_TEXTURE_2D, 0);
+}
+
+void Texture::upload(int width, int height, const void* pixels) {
+	// Generate Texture on First Upload
+	if (textureID == 0) {
+		glGenTextures(1, &textureID);
+		GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
+
+		// Setup Texture Properties to Bound Texture
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	else {
+		GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
+	}
+
+	// Specify & Load Data of Image Texture
+	glTexImage2D(
+		GL_TEXTURE_2D,
+		0,
+		GL_RGBA8,			// 8-bits (1Byte) per channel (0-255)
+		width,
+		height,
+		0,
+		GL_RGBA,
+		GL_UNSIGNED_BYTE,
+		pixels
+	);
+
+	// Uploads through a bound Pixel Unpack Buffer are counted by its owner
+	if (pixels) GLState::countUpload((size_t)width * height * 4);
+
+	// Generate a Mipmap for the Texture
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	this->width = width;
+	this->height = height;
+}
+
+bool Texture::upload(const CompressedImage& image) {
+	// Make sure the Driver can sample the Format
+	const bool s3tc = image.format != GL_COMPRESSED_RGBA_BPTC_UNORM && image.format != GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+	if (s3tc && !GLEW_EXT_texture_compression_s3tc) {
+		spdlog::error("Texture: S3TC (BC1/BC3) Compression not Supported");
+		return false;
+	}
+
+	if (textureID == 0) glGenTextures(1, &textureID);
+	GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
+
+	// Sample the stored Mipmaps only
+	const GLint levels = image.levels.size();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+	for (GLint i = 0; i < levels; i++) {
+		const CompressedLevel &level = image.levels[i];
+		glCompressedTexImage2D(GL_TEXTURE_2D, i, image.format, level.width, level.height, 0, level.size, level.data);
+		GLState::countUpload(level.size);
+	}
+
+	this->width = image.width;
+	this->height = image.height;
+	return true;
+}
+
+int Texture::getWidth() const {
+	return width;
+}
+
+int Texture::getHeight() const {
+	return height;
+}
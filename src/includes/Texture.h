@@ -1,5 +1,6 @@
 #pragma once
 #include <GL/glew.h>
+#include "utils/TextureFile.h"
 
 #include <iostream>
 
@@ -15,6 +16,7 @@ class Texture {
 
   public:
     GLuint textureID;
+    bool flipY;         // Stored top row first (DDS/KTX2), Shapes sample it with v' = 1 - v
 
     /*
     * Default Constructor
@@ -23,11 +25,26 @@ class Texture {
     Texture();
 
     /*
-    * Loads Texture from Source Given
+    * Loads Texture from Source Given. DDS & KTX2 files are
+    *	uploaded compressed, with their stored Mipmaps, & flagged flipY.
     *	@param src - Location of Texture Image
     */
     Texture(const char*);
 
+    /*
+    * Creates Texture from RGBA Pixels in Memory
+    *	@param width - Width of the Image
+    *	@param height - Height of the Image
+    *	@param pixels - RGBA Pixels, bottom row first
+    */
+    Texture(int, int, const void*);
+
+    /*
+    * Creates Texture from a Block Compressed Image & its Mipmaps, flagged flipY
+    *	@param image - Compressed Image, top block row first
+    */
+    Texture(const CompressedImage&);
+
     /*
     * Frees up Used Memory
     */
@@ -43,4 +60,25 @@ class Texture {
     * Unbinds current Texture
     */
     void unbind();
+
+    /*
+    * Specifies the RGBA Image of the Texture & regenerates its Mipmaps.
+    *	When a Pixel Unpack Buffer is bound, pixels is an offset into it.
+    *	@param width - Width of the Image
+    *	@param height - Height of the Image
+    *	@param pixels - RGBA Pixels, bottom row first
+    */
+    void upload(int, int, const void*);
+
+    /*
+    * Specifies the Compressed Image of the Texture, with its stored Mipmaps.
+    *	Nothing is generated, a single level is sampled without Mipmaps.
+    *	@param image - Compressed Image, top block row first (see flipY)
+    *	@returns Whether the format is supported by the driver
+    */
+    bool upload(const CompressedImage&);
+
+    /* Image Dimensions */
+    int getWidth() const;
+    int getHeight() const;
 };
\ No newline at end of file
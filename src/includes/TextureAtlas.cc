@@ -0,0 +1,179 @@
+#include <stb_image/stb_image.h>
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include "AssetPack.h"
+#include "GLState.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+
+/*
+ ***************************************************************
+ * Constructors
+ *	- Mip levels are limited to the ones whose texels stay within
+ *	an image's padding
+ ***************************************************************
+ */
+TextureAtlas::TextureAtlas(int pageSize, int padding) :
+  pageSize(pageSize),
+  padding(std::max(padding, 0)),
+  maxLevel(0) {
+  while ((2 << this->maxLevel) <= this->padding) this->maxLevel++;
+}
+
+
+/*
+ ***************************************************************
+ * Queueing Images
+ ***************************************************************
+ */
+size_t TextureAtlas::add(const std::string &path) {
+  const size_t region = this->regions.size();
+  this->regions.push_back({ nullptr, glm::vec2(0.f), glm::vec2(0.f), 0, 0 });
+  this->pending.push_back({ region, path, 0, 0, {} });
+  return region;
+}
+
+size_t TextureAtlas::add(int width, int height, const void *pixels) {
+  const size_t region = this->regions.size();
+  this->regions.push_back({ nullptr, glm::vec2(0.f), glm::vec2(0.f), width, height });
+
+  const unsigned char *src = static_cast<const unsigned char*>(pixels);
+  this->pending.push_back({ region, "", width, height, { src, src + (size_t)width * height * 4 } });
+  return region;
+}
+
+
+/*
+ ***************************************************************
+ * Building the Atlas
+ *	- Decode the queued files in parallel
+ *	- Pack tallest first, opening pages as needed
+ *	- Copy each image with its bleed & rebuild the mips of the
+ *	modified pages
+ ***************************************************************
+ */
+void TextureAtlas::build() {
+  if (this->pending.empty()) return;
+
+  // Decode the queued files, each thread taking the next image.
+  {
+    std::atomic<size_t> next(0);
+    auto decode = [this, &next]() {
+      stbi_set_flip_vertically_on_load_thread(true);
+
+      for (size_t i = next++; i < this->pending.size(); i = next++) {
+        Pending &image = this->pending[i];
+        if (image.path.empty()) continue;
+
+        int channels;
+        Asset asset;
+        unsigned char *data = AssetPack::get().find(image.path, asset)
+          ? stbi_load_from_memory(asset.data, asset.size, &image.width, &image.height, &channels, 4)
+          : stbi_load(image.path.c_str(), &image.width, &image.height, &channels, 4);
+        if (!data) {
+          spdlog::warn("TextureAtlas: Failed to load '{}': {}", image.path, stbi_failure_reason());
+          image.width = image.height = 0;
+          continue;
+        }
+
+        image.pixels.assign(data, data + (size_t)image.width * image.height * 4);
+        stbi_image_free(data);
+      }
+    };
+
+    const size_t threads = std::min<size_t>(
+      std::max(std::thread::hardware_concurrency(), 1u),
+      std::min<size_t>(this->pending.size(), TEXTURE_DECODE_THREADS)
+    );
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; i++)
+      workers.emplace_back(decode);
+    decode();
+    for (std::thread &worker : workers) worker.join();
+  }
+
+  // Tallest first keeps the skyline flat.
+  std::stable_sort(this->pending.begin(), this->pending.end(), [](const Pending &a, const Pending &b) {
+    return a.height > b.height;
+  });
+
+  std::vector<bool> modified(this->pages.size(), false);
+  for (const Pending &image : this->pending) {
+    if (image.pixels.empty()) continue;
+
+    const size_t page = this->insert(image);
+    modified.resize(this->pages.size(), false);
+    modified[page] = true;
+  }
+
+  for (size_t i = 0; i < this->pages.size(); i++)
+    if (modified[i]) glGenerateTextureMipmap(this->pages[i].texture->textureID);
+
+  this->pending.clear();
+}
+
+TextureAtlas::Page& TextureAtlas::addPage(int width, int height) {
+  std::shared_ptr<Texture> texture = std::make_shared<Texture>(width, height, nullptr);
+
+  // Sample the mips the padding protects.
+  glTextureParameteri(texture->textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTextureParameteri(texture->textureID, GL_TEXTURE_MAX_LEVEL, this->maxLevel);
+
+  this->pages.push_back({ texture, SkylinePacker(width, height) });
+  return this->pages.back();
+}
+
+size_t TextureAtlas::insert(const Pending &image) {
+  const int pad = this->padding;
+
+  // Sizes are rounded to the coarsest mip texel, so every image starts on one.
+  const int align = 1 << this->maxLevel;
+  const int w = (image.width + 2 * pad + align - 1) / align * align;
+  const int h = (image.height + 2 * pad + align - 1) / align * align;
+
+  glm::ivec2 position;
+  size_t index = 0;
+  while (index < this->pages.size() && !this->pages[index].packer.pack(w, h, position))
+    index++;
+
+  // Open a new page, of its own size if larger than a page.
+  if (index == this->pages.size())
+    this->addPage(std::max(w, this->pageSize), std::max(h, this->pageSize)).packer.pack(w, h, position);
+  Page *page = &this->pages[index];
+
+  // Extrude the edge texels into the padding.
+  std::vector<unsigned char> padded((size_t)w * h * 4);
+  for (int y = 0; y < h; y++) {
+    const int sy = std::clamp(y - pad, 0, image.height - 1);
+    for (int x = 0; x < w; x++) {
+      const int sx = std::clamp(x - pad, 0, image.width - 1);
+      memcpy(&padded[((size_t)y * w + x) * 4], &image.pixels[((size_t)sy * image.width + sx) * 4], 4);
+    }
+  }
+
+  glTextureSubImage2D(page->texture->textureID, 0, position.x, position.y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, padded.data());
+  GLState::countUpload(padded.size());
+
+  const glm::vec2 size(page->texture->getWidth(), page->texture->getHeight());
+  AtlasRegion &region = this->regions[image.region];
+  region.page = page->texture;
+  const glm::vec2 corner(position.x + pad, position.y + pad);
+  region.uvMin = corner / size;
+  region.uvMax = (corner + glm::vec2(image.width, image.height)) / size;
+  region.width = image.width;
+  region.height = image.height;
+  return index;
+}
+
+const AtlasRegion& TextureAtlas::get(size_t index) const {
+  return this->regions[index];
+}
+
+size_t TextureAtlas::getPageCount() const {
+  return this->pages.size();
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+// Library
+#include "Texture.h"
+#include "utils/SkylinePacker.h"
+
+// Core libraries
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/* Default width & height of an atlas page */
+#define ATLAS_PAGE_SIZE 2048
+
+/* Default texels of bleed around each image */
+#define ATLAS_PADDING 4
+
+
+/* Area of an atlas page holding a single image */
+struct AtlasRegion {
+  std::shared_ptr<Texture> page;  // Page the image was packed into, nullptr until built
+  glm::vec2 uvMin;                // Texture coordinates of the image's bottom-left corner
+  glm::vec2 uvMax;                // Texture coordinates of the image's top-right corner
+  int width, height;              // Size of the image in texels
+};
+
+
+/**
+ * Packs many small images into a few large texture pages, so that shapes
+ *  using different images still share a texture & draw in the same batch.
+ *  - Images are packed with a skyline packer, tallest first
+ *  - Each image's edge texels are extruded into its padding, so that
+ *  filtering & the first mip levels don't sample its neighbours
+ *  - Mip levels are capped to the ones the padding protects
+ *
+ * Shapes sample a region through Shape::set_texture_region.
+ */
+class TextureAtlas {
+  private:
+    /* Image waiting to be packed */
+    struct Pending {
+      size_t region;                  // Index of the region to fill
+      std::string path;               // Decoded on build(), empty if given pixels
+      int width, height;
+      std::vector<unsigned char> pixels;
+    };
+
+    /* Page & its packing state */
+    struct Page {
+      std::shared_ptr<Texture> texture;
+      SkylinePacker packer;
+    };
+
+  private:
+    int pageSize;
+    int padding;
+    int maxLevel;                   // Last mip level protected by the padding
+    std::vector<Page> pages;
+    std::vector<AtlasRegion> regions;
+    std::vector<Pending> pending;
+
+  private:
+    /* Creates an empty page of the given size */
+    Page& addPage(int width, int height);
+
+    /* Packs an image into a page & copies it over, with its bleed. Returns the page index */
+    size_t insert(const Pending &image);
+
+  public:
+    /**
+     * @param pageSize Width & height of each page, in texels.
+     * @param padding Texels of bleed around each image.
+     */
+    TextureAtlas(int pageSize = ATLAS_PAGE_SIZE, int padding = ATLAS_PADDING);
+
+    /**
+     * Queues an image file, packed on the next build().
+     *
+     * @param path Location of the Texture Image.
+     *
+     * @returns Index of the image's region.
+     */
+    size_t add(const std::string &path);
+
+    /**
+     * Queues an image from memory, packed on the next build().
+     *
+     * @param width Width of the image.
+     * @param height Height of the image.
+     * @param pixels RGBA pixels, bottom row first. Copied.
+     *
+     * @returns Index of the image's region.
+     */
+    size_t add(int width, int height, const void *pixels);
+
+    /**
+     * Decodes the queued image files in parallel, then packs & uploads
+     *  every queued image. Images that don't fit in the current pages open
+     *  a new page, images larger than a page get a page of their own.
+     *  Must be called on the GL thread.
+     */
+    void build();
+
+    /** Returns the region of an image, filled once built. */
+    const AtlasRegion& get(size_t) const;
+
+    /** Returns the number of pages. */
+    size_t getPageCount() const;
+};
@@ -0,0 +1,257 @@
+#include <stb_image/stb_image.h>
+#include "TextureCache.h"
+#include "GLState.h"
+#include "AssetPack.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+
+
+/* Texel shown until the image is uploaded, mid-grey */
+static const GLubyte PLACEHOLDER_TEXEL[4] = { 128, 128, 128, 255 };
+
+
+/*
+ ***************************************************************
+ * Constructors & Destructors
+ *	- Cache is shared, created on first use
+ *	- Destructor only stops the workers, GL Objects are released
+ *	on destroy() while the GL Context is current
+ ***************************************************************
+ */
+TextureCache::TextureCache() :
+  pending(0),
+  failed(0),
+  pbo(0),
+  running(false) {}
+
+TextureCache::~TextureCache() {
+  this->stop();
+}
+
+TextureCache& TextureCache::get() {
+  static TextureCache cache;
+  return cache;
+}
+
+void TextureCache::destroy() {
+  this->stop();
+  GLState::deleteBuffer(this->pbo);
+  this->pbo = 0;
+  this->pending = 0;
+}
+
+
+/*
+ ***************************************************************
+ * Worker Threads
+ *	- Started on the first request
+ *	- Decode requested images, handing them back to the GL
+ *	thread through the decoded queue
+ ***************************************************************
+ */
+void TextureCache::start() {
+  if (!this->workers.empty()) return;
+
+  // Leave a core to the render thread.
+  const size_t threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, TEXTURE_DECODE_THREADS + 1) - 1;
+
+  this->running = true;
+  for (size_t i = 0; i < threads; i++)
+    this->workers.emplace_back(&TextureCache::work, this);
+}
+
+void TextureCache::stop() {
+  if (this->workers.empty()) return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->running = false;
+    this->requests.clear();
+  }
+  this->wakeup.notify_all();
+  for (std::thread &worker : this->workers) worker.join();
+  this->workers.clear();
+
+  for (Decoded &image : this->decoded)
+    stbi_image_free(image.pixels);
+  this->decoded.clear();
+}
+
+void TextureCache::work() {
+  // Flipping is per thread, the Texture constructor sets it on the render thread.
+  stbi_set_flip_vertically_on_load_thread(true);
+
+  for (;;) {
+    std::string path;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->wakeup.wait(lock, [this] { return !this->running || !this->requests.empty(); });
+      if (!this->running) return;
+
+      path = std::move(this->requests.front());
+      this->requests.pop_front();
+    }
+
+    // Packed images are read from the mapping, compressed ones in place.
+    Decoded image { path, 0, 0, nullptr, nullptr };
+    Asset asset;
+    const bool packed = AssetPack::get().find(path, asset);
+    if (TextureFile::is_compressed(path)) {
+      const bool loaded = packed
+        ? TextureFile::parse(asset.data, asset.size, image.compressed)
+        : TextureFile::load(path, image.compressed);
+      if (!loaded) image.error = "invalid DDS/KTX2";
+    }
+
+    // Load in the Image (RGBA Channels)
+    else {
+      int channels;
+      image.pixels = packed
+        ? stbi_load_from_memory(asset.data, asset.size, &image.width, &image.height, &channels, 4)
+        : stbi_load(path.c_str(), &image.width, &image.height, &channels, 4);
+      if (!image.pixels) image.error = stbi_failure_reason();
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->running) {
+      stbi_image_free(image.pixels);
+      return;
+    }
+    this->decoded.push_back(std::move(image));
+    this->delivered.notify_one();
+  }
+}
+
+
+/*
+ ***************************************************************
+ * Texture Requests & Uploads
+ *	- Requests hand out the cached Texture, or a placeholder
+ *	while the image is decoded
+ *	- Decoded images are uploaded once per frame
+ ***************************************************************
+ */
+std::shared_ptr<Texture> TextureCache::load(const std::string &path) {
+  auto it = this->textures.find(path);
+  if (it != this->textures.end()) {
+    if (std::shared_ptr<Texture> texture = it->second.lock())
+      return texture;
+  }
+
+  // Placeholder until the image is decoded & uploaded. Shapes map their
+  // texture coordinates on creation, so the orientation is known up front.
+  std::shared_ptr<Texture> texture = std::make_shared<Texture>(1, 1, PLACEHOLDER_TEXEL);
+  texture->flipY = TextureFile::is_compressed(path);
+  this->textures[path] = texture;
+  this->pending++;
+
+  this->start();
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->requests.push_back(path);
+  }
+  this->wakeup.notify_one();
+
+  return texture;
+}
+
+void TextureCache::update() {
+  if (this->pending == 0) return;
+
+  // Take the images fitting in this frame's budget, at least one.
+  std::vector<Decoded> ready;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    size_t bytes = 0;
+    while (!this->decoded.empty() && (ready.empty() || bytes < TEXTURE_UPLOAD_BUDGET)) {
+      const Decoded &image = this->decoded.front();
+      if (image.compressed.levels.empty())
+        bytes += (size_t)image.width * image.height * 4;
+      for (const CompressedLevel &level : image.compressed.levels)
+        bytes += level.size;
+      ready.push_back(std::move(this->decoded.front()));
+      this->decoded.pop_front();
+    }
+  }
+
+  for (Decoded &image : ready) {
+    this->pending--;
+
+    auto it = this->textures.find(image.path);
+    std::shared_ptr<Texture> texture = it != this->textures.end() ? it->second.lock() : nullptr;
+
+    // Every handle was dropped while decoding.
+    if (!texture) {
+      if (it != this->textures.end()) this->textures.erase(it);
+    }
+
+    // Compressed blocks are small & final, uploaded straight from memory.
+    else if (!image.compressed.levels.empty()) {
+      if (!texture->upload(image.compressed)) this->failed++;
+    }
+
+    // ERROR: Texture not Loaded, the placeholder stays
+    else if (!image.pixels) {
+      spdlog::warn("TextureCache: Failed to load '{}': {}", image.path, image.error ? image.error : "unknown");
+      this->failed++;
+    }
+
+    else {
+      this->upload(*texture, image);
+    }
+
+    stbi_image_free(image.pixels);
+  }
+}
+
+void TextureCache::wait() {
+  while (this->pending > 0 && !this->workers.empty()) {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->delivered.wait(lock, [this] { return !this->decoded.empty(); });
+    }
+    this->update();
+  }
+}
+
+void TextureCache::upload(Texture &texture, const Decoded &image) {
+  const size_t size = (size_t)image.width * image.height * 4;
+
+  if (this->pbo == 0)
+    glCreateBuffers(1, &this->pbo);
+
+  // Orphan the previous store, so the copy doesn't wait on the last upload.
+  glNamedBufferData(this->pbo, size, nullptr, GL_STREAM_DRAW);
+
+  void *dst = glMapNamedBufferRange(this->pbo, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (!dst) {
+    // Fall back to uploading from client memory.
+    texture.upload(image.width, image.height, image.pixels);
+    return;
+  }
+  memcpy(dst, image.pixels, size);
+  glUnmapNamedBuffer(this->pbo);
+  GLState::countUpload(size);
+
+  // Pixels are sourced from the bound PBO, at offset 0.
+  GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, this->pbo);
+  texture.upload(image.width, image.height, nullptr);
+  GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+size_t TextureCache::getPending() const {
+  return this->pending;
+}
+
+size_t TextureCache::getFailed() const {
+  return this->failed;
+}
+
+size_t TextureCache::getLoaded() const {
+  size_t loaded = 0;
+  for (const auto &entry : this->textures)
+    if (!entry.second.expired()) loaded++;
+  return loaded;
+}
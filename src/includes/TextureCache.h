@@ -0,0 +1,112 @@
+#pragma once
+
+// Library
+#include "Texture.h"
+
+// Core libraries
+#include <GL/glew.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+/* Max bytes of decoded pixels uploaded per frame, at least one image is uploaded */
+#define TEXTURE_UPLOAD_BUDGET (16 << 20)
+
+/* Max number of decoding threads */
+#define TEXTURE_DECODE_THREADS 4
+
+
+/**
+ * Shared cache of Textures, keyed by path.
+ *  - Each image is decoded once, on a pool of worker threads. DDS/KTX2
+ *  files are only read, their blocks are uploaded as stored & their
+ *  Textures flagged flipY
+ *  - Decoded images are uploaded through a pixel unpack buffer on
+ *  the GL thread, within a per-frame budget
+ *  - Handles show a placeholder texel until their image is uploaded
+ *  - Handles are ref-counted, a Texture is freed with its last handle
+ */
+class TextureCache {
+  private:
+    /* Result of a decode, pixels are nullptr on failure or when compressed */
+    struct Decoded {
+      std::string path;
+      int width, height;
+      unsigned char *pixels;
+      const char *error;                  // Reason the decode failed
+      CompressedImage compressed;         // DDS/KTX2 blocks, no levels if not compressed
+    };
+
+  private:  // Render thread state
+    std::unordered_map<std::string, std::weak_ptr<Texture>> textures;
+    size_t pending;                       // Requested images not yet uploaded
+    size_t failed;                        // Requested images that failed to load
+    GLuint pbo;                           // Pixel Unpack Buffer
+
+  private:  // Worker thread state
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable delivered;    // Notified on each decoded image
+    std::deque<std::string> requests;     // Paths waiting to be decoded
+    std::deque<Decoded> decoded;          // Images waiting to be uploaded
+    bool running;
+
+  private:
+    TextureCache();
+
+    /* Worker thread loop */
+    void work();
+
+    /* Starts the workers, on the first request */
+    void start();
+
+    /* Stops & joins the workers, freeing any undelivered images */
+    void stop();
+
+    /* Uploads a decoded image into the texture, through the PBO */
+    void upload(Texture &texture, const Decoded &image);
+
+  public:
+    ~TextureCache();
+
+    /* Returns the cache shared by all Shapes */
+    static TextureCache& get();
+
+    /**
+     * Returns the Texture of the given image, requesting it on first use.
+     *  Must be called on the GL thread.
+     *	@param path - Location of the Texture Image
+     */
+    std::shared_ptr<Texture> load(const std::string &path);
+
+    /**
+     * Called once per frame on the GL thread. Uploads the images decoded
+     *  since the last call, up to TEXTURE_UPLOAD_BUDGET bytes.
+     */
+    void update();
+
+    /**
+     * Blocks until every requested image is decoded & uploaded. Used when
+     *  the first frames must be complete, such as headless renders.
+     */
+    void wait();
+
+    /* Stops the workers & releases the GL Objects. Textures in use stay valid */
+    void destroy();
+
+    /* Returns the number of images still being decoded or uploaded */
+    size_t getPending() const;
+
+    /* Returns the number of images that failed to load, left as the placeholder */
+    size_t getFailed() const;
+
+    /* Returns the number of unique Textures in use */
+    size_t getLoaded() const;
+};
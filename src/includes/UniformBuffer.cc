@@ -0,0 +1,40 @@
+#include "UniformBuffer.h"
+#include "GLState.h"
+
+#include <cstring>
+
+
+/*
+ ***************************************************************
+ * Constructors & GL Resources
+ *	- Constructor
+ *		- Configures the binding point and size of the block
+ *	- Initialize & Destroy the buffer object
+ ***************************************************************
+ */
+UniformBuffer::UniformBuffer(GLuint binding, size_t size) :
+  ID(0),
+  binding(binding),
+  data(size, 0) {}
+
+void UniformBuffer::init() {
+  glGenBuffers(1, &this->ID);
+  GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ID);
+  glBufferData(GL_UNIFORM_BUFFER, this->data.size(), this->data.data(), GL_DYNAMIC_DRAW);
+
+  // Programs link their block to this binding point.
+  glBindBufferBase(GL_UNIFORM_BUFFER, this->binding, this->ID);
+}
+
+void UniformBuffer::destroy() {
+  GLState::deleteBuffer(this->ID);
+  this->ID = 0;
+}
+
+void UniformBuffer::update(const void *value) {
+  if (memcmp(this->data.data(), value, this->data.size()) == 0) return;
+
+  memcpy(this->data.data(), value, this->data.size());
+  glNamedBufferSubData(this->ID, 0, this->data.size(), this->data.data());
+  GLState::countUpload(this->data.size());
+}
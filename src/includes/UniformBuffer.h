@@ -0,0 +1,56 @@
+#pragma once
+
+// Core libraries
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+
+/* Binding point & block name of the per-frame globals shared by all programs */
+#define FRAME_DATA_BINDING      0
+#define FRAME_DATA_BLOCK_NAME   "FrameData"
+
+/**
+ * Per-frame globals, laid out to match the std140 "FrameData"
+ *  uniform block declared in the shaders.
+ */
+struct FrameData {
+  glm::mat4 transform;    // View transform               (offset 0)
+  glm::vec2 u_res;        // Window resolution            (offset 64)
+  glm::vec2 u_mouse;      // Mouse position               (offset 72)
+  GLfloat u_time;         // Time since start, in seconds (offset 80)
+  GLfloat _padding[3];    // std140 rounds blocks up to 16 bytes
+};
+static_assert(sizeof(FrameData) == 96, "FrameData must match the std140 layout");
+
+
+/**
+ * Uniform Buffer Object bound to a fixed binding point,
+ *  shared by all programs declaring the matching block.
+ */
+class UniformBuffer {
+  private:
+    GLuint ID;                      // Buffer Object
+    GLuint binding;                 // Binding point
+    std::vector<GLubyte> data;      // Copy of the last uploaded data
+
+  public:
+    /**
+     * Constructs the Uniform Buffer. GL Objects are created on init().
+     *	@param binding - Binding point of the buffer
+     *	@param size - Size of the block in bytes
+     */
+    UniformBuffer(GLuint binding, size_t size);
+
+    /* Creates the buffer & binds it. Requires a current GL Context */
+    void init();
+
+    /* Releases the GL Objects. Requires a current GL Context */
+    void destroy();
+
+    /**
+     * Uploads the block's data, skipped if unchanged.
+     *	@param value - Pointer to the block's data, of the constructed size
+     */
+    void update(const void *value);
+};
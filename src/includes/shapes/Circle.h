@@ -6,6 +6,9 @@
 class Circle: protected Shape {
   private:
     double radius;
+    glm::vec3 center;   // Center of the circle, in local space.
+    size_t quality;     // Maximum number of points, the highest level of detail.
+    size_t segments;    // Number of points of the current level of detail.
 
   public:
     /**
@@ -16,10 +19,19 @@ class Circle: protected Shape {
      * @param r Circle's radius
      * @param shader Pointer to the shader used
      * @param texturePath Optional path to the shape texture
-     * @param quality Number of points to generate for the circle
+     * @param quality Maximum number of points to generate for the circle
     */
     Circle(double, double, double, std::shared_ptr<Shader>, const char*, size_t);
     ~Circle();
 
   glm::vec3 get_center_vec();
+
+  /**
+   * Picks the number of points keeping the edge within LOD_PIXEL_TOLERANCE of
+   * the true arc on screen. Levels are powers of two, capped at the quality,
+   * so the geometry is only replaced when crossing a level.
+   *
+   * @param pixels_per_unit Screen pixels covered by one world unit.
+   */
+  void update_lod(float);
 };
\ No newline at end of file
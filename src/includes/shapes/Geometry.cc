@@ -0,0 +1,117 @@
+#include "Geometry.h"
+#include "utils/common.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+Mesh Geometry::rectangle(double x, double y, double width, double height) {
+  Mesh mesh;
+  mesh.verticies = {
+    // VERTEX<vec3>		                        RGBA<4 x ubyte>         // Texture Coordinates<vec2>
+    { x,              y,             0.0f,      255, 0,   0,   255,   0.0f, 0.0f },   // bottom-left
+    { x + width,      y,             0.0f,      0,   255, 0,   255,   1.0f, 0.0f },   // bottom-right
+    { x,              y + height,    0.0f,      0,   0,   255, 255,   0.0f, 1.0f },   // top-left
+    { x + width,      y + height,    0.0f,      0,   0,   0,   255,   1.0f, 1.0f }    // top-right
+  };
+
+  mesh.indicies = {
+    0, 3, 1,
+    0, 2, 3
+  };
+
+  return mesh;
+}
+
+Mesh Geometry::circle(double x, double y, double r, size_t quality) {
+  const Mesh &unit = Geometry::unit_circle(quality);
+
+  // Place the cached unit circle, texture coordinates are left untouched.
+  Mesh mesh = unit;
+  for (Vertex &v : mesh.verticies) {
+    v.x = x + v.x * r;
+    v.y = y + v.y * r;
+  }
+
+  return mesh;
+}
+
+const Mesh& Geometry::unit_circle(size_t quality) {
+  constexpr double TWO_PI = glm::two_pi<double>();
+
+  static std::unordered_map<size_t, Mesh> cache;
+  auto it = cache.find(quality);
+  if (it != cache.end()) return it->second;
+
+  // Include an additional point in the middle, which is used to link indicies.
+  Mesh &mesh = cache[quality];
+  mesh.verticies.reserve(quality + 1);
+  mesh.indicies.reserve(quality * 3);
+
+  /*
+    Map the texture to each vertex, over the bounding box [-1, 1].
+      - https://learnopengl.com/Getting-started/Textures
+
+    Draw starts at bottom left, where is texture land, is:
+      -----------------------------------
+      | (0,1)                     (1,1) |
+      |                                 |
+      |                                 |
+      |                                 |
+      |                                 |
+      |                                 |
+      |                                 |
+      |                                 |
+      | (0,0)                     (1,0) |
+      -----------------------------------
+  */
+
+  // Add initial data point in the center of the circle.
+  mesh.verticies.push_back({
+    0.f, 0.f, 0.f,
+    0, 0, 0, 0,
+    0.5f, 0.5f
+  });
+
+  // Now generate circle data points.
+  // PI Chart -> https://tinyurl.com/5mm8nm9c
+  const double circle_percision = TWO_PI / quality;
+  for (size_t i = 1; i <= quality; i++) {
+    const double v = circle_percision * i;
+    const double _x = glm::cos(v);
+    const double _y = glm::sin(v);
+
+    // Map the texture to each vertex point around the circle.
+    mesh.verticies.push_back({
+      _x, _y, 0.f,
+      0, 0, 0, 0,
+      normalizeFloat( _x, -1.f, 1.f, 0.f, 1.f ),
+      normalizeFloat( _y, -1.f, 1.f, 0.f, 1.f )
+    });
+  }
+
+  // Generate the indicies to map the center of the circle to 2 points across the
+  // circle's arc, looping around back to the first point.
+  for (size_t i = 1; i <= quality; i++) {
+    mesh.indicies.push_back(0);
+    mesh.indicies.push_back(i);
+    mesh.indicies.push_back(i == quality ? 1 : i + 1);
+  }
+
+  return mesh;
+}
+
+size_t Geometry::circle_segments(double radiusPixels, double tolerance, size_t minSegments, size_t maxSegments) {
+  constexpr double PI = glm::pi<double>();
+
+  // Sub-pixel circles, or a tolerance larger than the radius, need the fewest.
+  if (radiusPixels <= tolerance) return minSegments;
+
+  /*
+    A chord spanning an angle θ deviates from the arc by r(1 - cos(θ/2)).
+    Keeping that within the tolerance gives θ = 2·acos(1 - tol/r), so
+    2π / θ = π / acos(1 - tol/r) segments.
+  */
+  const double segments = glm::ceil(PI / glm::acos(1.0 - tolerance / radiusPixels));
+  return std::clamp((size_t)segments, minSegments, maxSegments);
+}
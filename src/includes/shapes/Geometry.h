@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+// Project Libraries
+#include "BufferData.h"
+
+/**
+ * CPU-side geometry, ready to be uploaded into a BufferData
+ *  or shared between instances.
+ */
+struct Mesh {
+  std::vector<Vertex> verticies;
+  std::vector<GLuint> indicies;
+
+  /* Size of the vertex data in bytes */
+  size_t vertex_size_bytes() const { return this->verticies.size() * sizeof(Vertex); }
+
+  /* Size of the index data in bytes */
+  size_t index_size_bytes() const { return this->indicies.size() * sizeof(GLuint); }
+};
+
+namespace Geometry {
+  /**
+   * Generates a rectangle's geometry.
+   *
+   * @param x Position of the bottom-left corner on x-axis
+   * @param y Position of the bottom-left corner on y-axis
+   * @param width Width of the rectangle
+   * @param height Height of the rectangle
+   */
+  Mesh rectangle(double x, double y, double width, double height);
+
+  /**
+   * Generates a circle's geometry as a triangle fan around the center.
+   *
+   * @param x Center on x-axis
+   * @param y Center on y-axis
+   * @param r Circle's radius
+   * @param quality Number of points to generate around the circle
+   */
+  Mesh circle(double x, double y, double r, size_t quality);
+
+  /**
+   * Returns a circle of radius 1 centered at (0, 0), tessellated once per
+   * quality & cached for the lifetime of the program.
+   *
+   * @param quality Number of points around the circle
+   */
+  const Mesh& unit_circle(size_t quality);
+
+  /**
+   * Number of segments needed for a circle's edge to stay within a given
+   * screen-space error, clamped within [minSegments, maxSegments].
+   *
+   * @param radiusPixels Projected radius in pixels
+   * @param tolerance Maximum distance in pixels between the edge & the true arc
+   * @param minSegments Lower bound of the segment count
+   * @param maxSegments Upper bound of the segment count
+   */
+  size_t circle_segments(double radiusPixels, double tolerance, size_t minSegments, size_t maxSegments);
+};
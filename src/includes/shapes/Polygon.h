@@ -15,6 +15,15 @@ class Polygon: protected Shape {
      * @param texturePath Optional path to the shape texture
     */
     Polygon(const std::vector<glm::vec2> &vertices, std::shared_ptr<Shader> shader, const char* texturePath);
+
+    /**
+     * Initializes a 2d polygon instance with holes.
+     *
+     * @param rings Outer ring of (x,y) points, followed by each hole's ring.
+     * @param shader Pointer to the shader used
+     * @param texturePath Optional path to the shape texture
+    */
+    Polygon(const std::vector<std::vector<glm::vec2>> &rings, std::shared_ptr<Shader> shader, const char* texturePath);
     ~Polygon();
 
     glm::vec3 get_center_vec();
@@ -1,36 +1,33 @@
 #include "Rectangle.h"
+#include "Geometry.h"
 
 Rectangle::Rectangle(double x, double y, double width, double height, std::shared_ptr<Shader> shader, const char* texturePath) {
   this->width = width;
   this->height = height;
   this->set_origin(glm::vec3{ x, y, 0.f });
 
-  GLdouble verticies[] = {
-    // VERTEX<vec3>		                        RGBA<vec4>					      // Texture Coordinates<vec2>
-    x,              y,             0.0f,      1.0f, 0.0f, 0.0f, 1.0f,   0.0f, 0.0f,   // bottom-left
-    x + width,      y,             0.0f,      0.0f, 1.0f, 0.0f, 1.0f,   1.0f, 0.0f,   // bottom-right
-    x,              y + height,    0.0f,      0.0f, 0.0f, 1.0f, 1.0f,   0.0f, 1.0f,   // top-left
-    x + width,      y + height,    0.0f,      0.0f, 0.0f, 0.0f, 1.0f,   1.0f, 1.0f    // top-right
-  };
+  Mesh mesh = Geometry::rectangle(x, y, width, height);
 
-  GLuint indicies[] = {
-    0, 3, 1,
-    0, 2, 3
-  };
-
-  this->buffer = CreateBuffer::dynamic_float(verticies, sizeof(verticies), indicies, sizeof(indicies), shader);
+  this->buffer = CreateBuffer::local_float(
+    mesh.verticies.data(),
+    mesh.vertex_size_bytes(),
+    mesh.indicies.data(),
+    mesh.index_size_bytes(),
+    shader
+  );
   if (texturePath)
-    this->buffer.texture = new Texture(texturePath);
+    this->set_texture(TextureCache::get().load(texturePath));
 };
 
 Rectangle::~Rectangle() {}
 
 glm::vec3 Rectangle::get_center_vec() {
-  const double x0 = this->buffer.vertex_buffer_ptr[0];
-  const double y0 = this->buffer.vertex_buffer_ptr[1];
-  const double z0 = this->buffer.vertex_buffer_ptr[2];
+  const double x0 = this->buffer.vertex_buffer_ptr[0].x;
+  const double y0 = this->buffer.vertex_buffer_ptr[0].y;
+  const double z0 = this->buffer.vertex_buffer_ptr[0].z;
 
-  return glm::vec3(
+  // Local geometry is immutable, map the local center into world space.
+  return this->to_world(glm::vec3(
     // Half of the rectangle's width, offset at the x-axis.
     x0 + (this->width / 2.f),
 
@@ -40,5 +37,5 @@ glm::vec3 Rectangle::get_center_vec() {
 
     // Meh.
     z0
-  );
+  ));
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "SDFCircle.h"
+#include "Geometry.h"
+#include <spdlog/spdlog.h>
+
+SDFCircle::SDFCircle(double x, double y, double r, std::shared_ptr<Shader> shader, const char* texturePath):
+  SDFCircle(x, y, r, r, shader, texturePath) {}
+
+SDFCircle::SDFCircle(double x, double y, double rx, double ry, std::shared_ptr<Shader> shader, const char* texturePath) {
+  // Origin is the center of the ellipse.
+  this->radius_x = rx;
+  this->radius_y = ry;
+  this->center = glm::vec3{ x, y, 0.f };
+  this->set_origin(this->center);
+
+  // Single quad covering the bounding box, the edge is computed per pixel.
+  Mesh mesh = Geometry::rectangle(x - rx, y - ry, rx * 2.0, ry * 2.0);
+
+  this->buffer = CreateBuffer::local_float(
+    mesh.verticies.data(),
+    mesh.vertex_size_bytes(),
+    mesh.indicies.data(),
+    mesh.index_size_bytes(),
+    shader
+  );
+  if (texturePath)
+    this->set_texture(TextureCache::get().load(texturePath));
+
+  // Anti-aliased edge fades out, needs blending.
+  this->set_blend_mode(BlendMode::Alpha);
+}
+
+SDFCircle::~SDFCircle() {}
+
+glm::vec3 SDFCircle::get_center_vec() {
+  return this->to_world(this->center);
+}
+
+void SDFCircle::set_texture_region(const AtlasRegion&) {
+  spdlog::warn("SDFCircle: Atlas regions aren't supported, keeping its own texture");
+}
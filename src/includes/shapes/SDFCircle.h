@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Shape.h"
+
+/**
+ * Circle or ellipse drawn as a single quad. The edge is resolved per pixel
+ *  by the fragment shader (see shaders/sdf_circle.frag), using the distance
+ *  to the edge for analytic anti-aliasing.
+ *
+ * Texture coordinates span the bounding box, matching the ones Circle generates.
+ *  The edge is computed from them, so they can't be remapped into an atlas region.
+ */
+class SDFCircle: protected Shape {
+  private:
+    double radius_x, radius_y;
+    glm::vec3 center;   // Center of the ellipse, in local space.
+
+  public:
+    /**
+     * Initializes a circle instance.
+     *
+     * @param x Position on x-axis
+     * @param y Position on y-axis
+     * @param r Circle's radius
+     * @param shader Pointer to the shader used, expected to use sdf_circle.frag
+     * @param texturePath Optional path to the shape texture
+    */
+    SDFCircle(double, double, double, std::shared_ptr<Shader>, const char*);
+
+    /**
+     * Initializes an ellipse instance.
+     *
+     * @param x Position on x-axis
+     * @param y Position on y-axis
+     * @param rx Ellipse's radius on the x-axis
+     * @param ry Ellipse's radius on the y-axis
+     * @param shader Pointer to the shader used, expected to use sdf_circle.frag
+     * @param texturePath Optional path to the shape texture
+    */
+    SDFCircle(double, double, double, double, std::shared_ptr<Shader>, const char*);
+    ~SDFCircle();
+
+    glm::vec3 get_center_vec();
+
+    /** Atlas regions are rejected, the edge needs texture coordinates spanning [0, 1]. */
+    void set_texture_region(const AtlasRegion&) override;
+};
@@ -1,87 +1,192 @@
 #include "Shape.h"
+#include "Transform2D.h"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+
+Shape::Shape():
+  origin(0.f),
+  translation(0.f),
+  rotation(0.f),
+  scale_factor(1.f),
+  model(1.f),
+  model_dirty(false),
+  layer(0),
+  blend_mode(BlendMode::Opaque),
+  uv_min(0.f),
+  uv_max(1.f) {}
 
-Shape::Shape(): origin(0.f) {}
 Shape::~Shape() {
   this->buffer.freeBufferData(&this->buffer);
 }
 
 void Shape::set_origin(glm::vec3 origin) {
-  this->origin = origin;
+  // Origin is kept in local space, so that it follows the shape's translation.
+  // Pivot around the local point currently drawn at the new origin, & move the
+  // translation along so an already rotated or scaled shape stays in place.
+  const Affine2D m = Affine2D::from_matrix(this->get_model_matrix());
+  const float det = m.a * m.d - m.c * m.b;
+
+  glm::vec2 local = glm::vec2(origin) - this->translation;
+  if (det != 0.f) {
+    const glm::vec2 p = glm::vec2(origin) - glm::vec2(m.tx, m.ty);
+    local = { (m.d * p.x - m.c * p.y) / det, (m.a * p.y - m.b * p.x) / det };
+  }
+
+  this->origin = glm::vec3(local, origin.z);
+  this->translation = glm::vec2(origin) - local;
+  this->model_dirty = true;
 }
 
 glm::vec3 Shape::get_origin() {
-  return this->origin;
+  return this->origin + glm::vec3(this->translation, 0.f);
 }
 
-inline double Shape::get_buffer_length() {
-  return this->buffer.vertex_buffer_size_bytes / sizeof(GLdouble);
+inline size_t Shape::get_buffer_length() {
+  return this->buffer.vertex_count();
 }
 
-void Shape::translate(const glm::vec2 &t) {
-  for (size_t i = 0; i < this->get_buffer_length(); i += buffer.stride) {
-    buffer.vertex_buffer_ptr[i]      += t.x;
-    buffer.vertex_buffer_ptr[i + 1]  += t.y;
+glm::vec3 Shape::to_world(const glm::vec3 &v) {
+  return glm::vec3( this->get_model_matrix() * glm::vec4(v, 1.f) );
+}
+
+void Shape::map_texture_coords(Vertex *verticies, size_t count) const {
+  const bool flip = this->buffer.texture && this->buffer.texture->flipY;
+  const glm::vec2 extent = this->uv_max - this->uv_min;
+  for (size_t i = 0; i < count; i++) {
+    const float v = flip ? 1.f - verticies[i].v : verticies[i].v;
+    verticies[i].u = this->uv_min.x + verticies[i].u * extent.x;
+    verticies[i].v = this->uv_min.y + v * extent.y;
+  }
+}
+
+void Shape::remap_texture(std::shared_ptr<Texture> texture, const glm::vec2 &uv_min, const glm::vec2 &uv_max) {
+  const size_t count = this->get_buffer_length();
+  const bool flip = this->buffer.texture && this->buffer.texture->flipY;
+  const glm::vec2 extent = this->uv_max - this->uv_min;
+
+  // Back into [0, 1] from the previous texture & region, then into the new ones.
+  Vertex *verticies = this->buffer.vertex_buffer_ptr;
+  for (size_t i = 0; i < count; i++) {
+    const float v = (verticies[i].v - this->uv_min.y) / extent.y;
+    verticies[i].u = (verticies[i].u - this->uv_min.x) / extent.x;
+    verticies[i].v = flip ? 1.f - v : v;
   }
 
-  // Update origin to reflect translation.
-  this->set_origin( this->get_origin() + glm::vec3(t, 0.f) );
+  this->buffer.texture = texture;
+  this->uv_min = uv_min;
+  this->uv_max = uv_max;
+  this->map_texture_coords(verticies, count);
+  this->buffer.mark_verticies_dirty(0, count);
 }
 
-void Shape::iter_buffer(std::function<glm::vec3(glm::vec3&)> fn) {
-  // Create a translation to push/pop on shape's origin.
-  glm::mat4 push_translate_to_origin  = glm::translate(glm::mat4(1.f), -this->origin);
-  glm::mat4 pop_translate_to_origin   = glm::translate(glm::mat4(1.f),  this->origin);
+void Shape::set_texture(std::shared_ptr<Texture> texture) {
+  this->remap_texture(texture, this->uv_min, this->uv_max);
+}
 
-  for (size_t i = 0; i < this->get_buffer_length(); i += buffer.stride) {
-    const glm::vec3 vertex {
-      buffer.vertex_buffer_ptr[i],
-      buffer.vertex_buffer_ptr[i + 1],
-      buffer.vertex_buffer_ptr[i + 2]
-    };
+void Shape::translate(const glm::vec2 &t) {
+  this->translation += t;
+  this->model_dirty = true;
+}
+
+void Shape::rotate(const float radians) {
+  // Keep the accumulated angle bounded so it doesn't lose precision over time.
+  this->rotation = glm::mod(this->rotation + radians, glm::two_pi<float>());
+  this->model_dirty = true;
+}
+
+void Shape::scale(const glm::vec2& scale) {
+  this->scale_factor *= scale;
+  this->model_dirty = true;
+}
+
+const glm::mat4& Shape::get_model_matrix() {
+  if (this->model_dirty) {
+    // Rotate on z-axis since this is 2D.
+    constexpr glm::vec3 z_axis { 0.f, 0.f, 1.f };
 
     // Sprinkle some math magic.
     // 1. Translate to the shape's origin
-    glm::vec3 result = glm::vec3( push_translate_to_origin * glm::vec4(vertex, 1.f) );
+    // 2. Scale & Rotate
+    // 3. Pop origin translation & apply the shape's translation.
+    glm::mat4 m = glm::translate(glm::mat4(1.f), glm::vec3(this->translation, 0.f) + this->origin);
+    m = glm::rotate(m, this->rotation, z_axis);
+    m = glm::scale(m, glm::vec3(this->scale_factor, 1.f));
+    m = glm::translate(m, -this->origin);
+
+    this->model = m;
+    this->model_dirty = false;
+  }
 
-    // 2. Apply on vertex.
-    result = fn(result);
+  return this->model;
+}
 
-    // 3. Pop origin translation.
-    result = glm::vec3( pop_translate_to_origin * glm::vec4(result, 1.f) );
+void Shape::set_layer(short layer) {
+  this->layer = layer;
+}
 
-    // Update inner data buffer.
-    buffer.vertex_buffer_ptr[i]      = result.x;
-    buffer.vertex_buffer_ptr[i + 1]  = result.y;
-    buffer.vertex_buffer_ptr[i + 2]  = result.z;
-  }
+short Shape::get_layer() {
+  return this->layer;
 }
 
-void Shape::rotate(const float radians) {
-  // Rotate on z-axis since this is 2D.
-  constexpr glm::vec3 z_axis { 0.f, 0.f, 1.f };
+void Shape::set_blend_mode(BlendMode mode) {
+  this->blend_mode = mode;
+}
 
-  // Create rotation matrix.
-  const glm::mat4 rot_mat = glm::rotate(
-    glm::mat4(1.f),
-    radians,
-    z_axis
-  );
+BlendMode Shape::get_blend_mode() {
+  return this->blend_mode;
+}
+
+void Shape::set_vertex_position(size_t index, const glm::vec2 &position) {
+  if (index >= this->get_buffer_length()) return;
 
-  // Apply rotation matrix on all verticies.
-  this->iter_buffer([&](glm::vec3 &slice) -> glm::vec3 {
-    return glm::vec3( rot_mat * glm::vec4(slice, 1.f) );
-  });
+  Vertex &vertex = this->buffer.vertex_buffer_ptr[index];
+  vertex.x = position.x;
+  vertex.y = position.y;
+  this->buffer.mark_verticies_dirty(index, 1);
 }
 
-void Shape::scale(const glm::vec2& scale) {
-  glm::mat4 scale_mat = glm::scale( glm::mat4(1.f), glm::vec3(scale, 1.f) );
+void Shape::set_vertex_color(size_t first, size_t count, const glm::u8vec4 &color) {
+  const size_t length = this->get_buffer_length();
+  if (first >= length) return;
+  count = std::min(count, length - first);
+
+  for (size_t i = first; i < first + count; i++) {
+    Vertex &vertex = this->buffer.vertex_buffer_ptr[i];
+    vertex.r = color.r;
+    vertex.g = color.g;
+    vertex.b = color.b;
+    vertex.a = color.a;
+  }
+  this->buffer.mark_verticies_dirty(first, count);
+}
+
+void Shape::get_world_positions(std::vector<glm::vec2> &positions) {
+  const size_t count = this->get_buffer_length();
+  const Vertex *verticies = this->buffer.vertex_buffer_ptr;
+
+  positions.resize(count);
+  for (size_t i = 0; i < count; i++)
+    positions[i] = { verticies[i].x, verticies[i].y };
 
-  this->iter_buffer([&](glm::vec3 &slice) -> glm::vec3 {
-    return glm::vec3( scale_mat * glm::vec4(slice, 1.f) );
-  });
+  Transform2D::points(Affine2D::from_matrix(this->get_model_matrix()), positions.data(), positions.data(), count);
 }
 
+void Shape::update_lod(float) {}
+
 void Shape::update() {
-  buffer.update();
-}
\ No newline at end of file
+  // Refresh the model transform. Shapes are streamed from their local copy by
+  // the BatchRenderer, only buffers with a GPU store upload edited ranges.
+  this->get_model_matrix();
+  this->buffer.update();
+}
+
+void Shape::set_texture_region(const AtlasRegion &region) {
+  // Images that failed to load are never packed, their regions are empty.
+  // Only packed regions are kept, so the mapping below can be inverted.
+  if (!region.page || region.uvMax.x <= region.uvMin.x || region.uvMax.y <= region.uvMin.y) {
+    spdlog::warn("Shape: Atlas region isn't packed, keeping the current texture");
+    return;
+  }
+
+  this->remap_texture(region.page, region.uvMin, region.uvMax);
+}
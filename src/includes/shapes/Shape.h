@@ -1,7 +1,6 @@
 #pragma once
 
 #include <vector>
-#include <functional>
 
 // Graphics libraries.
 #include <glm/glm.hpp>
@@ -9,35 +8,71 @@
 
 // Project Libraries
 #include "Texture.h"
+#include "TextureCache.h"
+#include "TextureAtlas.h"
 #include "BufferData.h"
+#include "GLState.h"
 
 class Shape {
   protected:
-    glm::vec3 origin;
+    glm::vec3 origin;         // Pivot for rotation & scaling, in local space.
+    glm::vec2 translation;    // Translation applied on top of the local geometry.
+    float rotation;           // Rotation, in radians, around the origin.
+    glm::vec2 scale_factor;   // Scale around the origin.
+
+    glm::mat4 model;          // Cached model transform.
+    bool model_dirty;         // Model transform needs to be rebuilt.
+
+    short layer;              // Draw layer, higher layers are drawn on top.
+    BlendMode blend_mode;     // Blending used when drawing the shape.
+
+    glm::vec2 uv_min;         // Texture coordinates mapped from (0, 0).
+    glm::vec2 uv_max;         // Texture coordinates mapped from (1, 1).
 
   public:
     BufferData buffer;
 
   protected:
-    /* Internal helper function which returns the buffer's length. **/
-    inline double get_buffer_length();
+    /* Internal helper function which returns the number of verticies in the buffer. **/
+    inline size_t get_buffer_length();
 
     /**
-     * Internal helper function which applies a change to the internal buffer
-     * by calling the given function on the vec3 vertex slice wrapped in a origin
-     * translation.
+     * Transforms a point from the shape's local space into world space using
+     * the shape's model transform.
      *
-     * @param fn Function called to apply a change on the vertex argument.
-    */
-    void iter_buffer(std::function<glm::vec3 (glm::vec3&)>);
+     * @param v Local space point.
+     */
+    glm::vec3 to_world(const glm::vec3&);
+
+    /**
+     * Maps texture coordinates within [0, 1] into the shape's texture
+     * region, with v flipped for textures stored top row first. Used when
+     * regenerating the local geometry.
+     *
+     * @param verticies Verticies to map in place.
+     * @param count Number of verticies.
+     */
+    void map_texture_coords(Vertex*, size_t) const;
+
+    /**
+     * Sets the shape's texture, mapping the texture coordinates of its
+     * local geometry for the texture's orientation.
+     *
+     * @param texture Texture to sample.
+     */
+    void set_texture(std::shared_ptr<Texture>);
+
+  private:
+    /* Moves the texture coordinates from the current texture & region into the given ones */
+    void remap_texture(std::shared_ptr<Texture>, const glm::vec2&, const glm::vec2&);
 
   public:
     Shape();
     virtual ~Shape();
 
     /**
-     * Translates the shape by the given vector. This is done by mutating the
-     * internal buffer and updating the buffer storage.
+     * Translates the shape by the given vector. The local geometry is left
+     * untouched, only the model transform is updated.
      *
      * @param v 2D Vector to traslate entity by.
     */
@@ -49,30 +84,92 @@ class Shape {
     virtual glm::vec3 get_center_vec() = 0;
 
     /**
-     * Sets the shape's origin.
+     * Sets the shape's origin, the pivot of later rotations & scales. The
+     * shape stays where it is on screen.
      *
-     * @param x Origin at x-axis.
-     * @param y Origin at y-axis.
+     * @param origin World space origin.
      */
     void set_origin(glm::vec3);
 
-    /** Returns the shape's origin. */
+    /** Returns the shape's origin, in world space. */
     glm::vec3 get_origin();
 
     /**
-     * Rotates the current shape instance, in-place, by the given radians.
+     * Rotates the current shape instance around its origin by the given radians.
      *
      * @param radians Radians to rotate the shape by.
      */
     void rotate(const float);
 
     /**
-     * Scales the shape by the given vector.
+     * Scales the shape by the given vector around its origin.
      *
      * @param scale vec2 scale factor.
      */
     void scale(const glm::vec2&);
 
+    /**
+     * Returns the model transform, mapping the local geometry into world
+     * space. Rebuilt only when the transform changed.
+     */
+    const glm::mat4& get_model_matrix();
+
+    /** Sets the draw layer. Higher layers are drawn on top. */
+    void set_layer(short);
+
+    /** Returns the draw layer. */
+    short get_layer();
+
+    /** Sets the blending used when drawing the shape. */
+    void set_blend_mode(BlendMode);
+
+    /** Returns the blending used when drawing the shape. */
+    BlendMode get_blend_mode();
+
+    /**
+     * Moves a single vertex of the local geometry. Shapes are streamed from
+     * their local geometry, so it's drawn moved from the next frame on.
+     *
+     * @param index Index of the vertex to move.
+     * @param position New local space position.
+     */
+    void set_vertex_position(size_t, const glm::vec2&);
+
+    /**
+     * Sets the color of a range of verticies, drawn from the next frame on.
+     *
+     * @param first Index of the first vertex.
+     * @param count Number of verticies to color.
+     * @param color RGBA color, each channel within [0, 255].
+     */
+    void set_vertex_color(size_t, size_t, const glm::u8vec4&);
+
+    /**
+     * Selects the level of detail for the current on-screen size. Shapes
+     * without curved edges have a single level.
+     *
+     * @param pixels_per_unit Screen pixels covered by one world unit.
+     */
+    virtual void update_lod(float);
+
+    /**
+     * Samples the shape's texture from an atlas region, so that shapes
+     * using different images can share a texture & batch. Texture
+     * coordinates are remapped into the region. Regions that weren't packed,
+     * such as images that failed to load, are skipped.
+     *
+     * @param region Region of the shape's image within an atlas page.
+     */
+    virtual void set_texture_region(const AtlasRegion&);
+
+    /**
+     * Writes the world space positions of the shape's verticies, for CPU
+     * side work like picking, collisions or exporting.
+     *
+     * @param positions Resized to the vertex count & filled.
+     */
+    void get_world_positions(std::vector<glm::vec2>&);
+
     /** Updates entity state */
     void update();
 };
@@ -0,0 +1,99 @@
+#include "FileWatcher.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <filesystem>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+/* Events of a file written in place, or replaced through a rename */
+static const uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+FileWatcher::FileWatcher() :
+  inotify_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+  wakeup_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+  if (this->inotify_fd < 0 || this->wakeup_fd < 0) {
+    spdlog::error("FileWatcher: Failed to initialize inotify");
+    return;
+  }
+
+  this->thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher() {
+  if (this->thread.joinable()) {
+    const uint64_t stop = 1;
+    if (write(this->wakeup_fd, &stop, sizeof(stop)) < 0)
+      spdlog::warn("FileWatcher: Failed to stop the watcher thread");
+    this->thread.join();
+  }
+
+  if (this->inotify_fd >= 0) close(this->inotify_fd);
+  if (this->wakeup_fd >= 0) close(this->wakeup_fd);
+}
+
+bool FileWatcher::watch(const std::string &path) {
+  if (this->inotify_fd < 0) return false;
+
+  const std::filesystem::path file = std::filesystem::path(path).lexically_normal();
+  const std::string normalized = file.string();
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->watched.count(normalized)) return true;
+
+  // Adding an existing directory returns its descriptor again.
+  const std::string directory = file.has_parent_path() ? file.parent_path().string() : ".";
+  const int wd = inotify_add_watch(this->inotify_fd, directory.c_str(), WATCH_EVENTS);
+  if (wd < 0) {
+    spdlog::warn("FileWatcher: Failed to watch '{}'", directory);
+    return false;
+  }
+
+  Directory &entry = this->directories[wd];
+  entry.path = directory;
+  entry.files[file.filename().string()] = normalized;
+  this->watched.insert(normalized);
+  return true;
+}
+
+void FileWatcher::poll(std::vector<std::string> &changes) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  changes.insert(changes.end(), this->changed.begin(), this->changed.end());
+  this->changed.clear();
+}
+
+void FileWatcher::run() {
+  alignas(struct inotify_event) char buffer[4096];
+  pollfd fds[2] = {
+    { this->inotify_fd, POLLIN, 0 },
+    { this->wakeup_fd, POLLIN, 0 }
+  };
+
+  while (true) {
+    if (::poll(fds, 2, -1) < 0) continue;   // Interrupted
+    if (fds[1].revents) return;              // Stopped
+
+    ssize_t length;
+    while ((length = read(this->inotify_fd, buffer, sizeof(buffer))) > 0) {
+      std::lock_guard<std::mutex> lock(this->mutex);
+
+      for (char *ptr = buffer; ptr < buffer + length;) {
+        const inotify_event *event = reinterpret_cast<const inotify_event*>(ptr);
+        ptr += sizeof(inotify_event) + event->len;
+        if (event->len == 0) continue;
+
+        auto directory = this->directories.find(event->wd);
+        if (directory == this->directories.end()) continue;
+
+        auto file = directory->second.files.find(event->name);
+        if (file == directory->second.files.end()) continue;
+
+        // Collapse repeated writes until the next poll.
+        if (std::find(this->changed.begin(), this->changed.end(), file->second) == this->changed.end())
+          this->changed.push_back(file->second);
+      }
+    }
+  }
+}
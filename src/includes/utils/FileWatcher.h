@@ -0,0 +1,61 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Watches files for changes with inotify, on a background thread.
+ *  - Each file's directory is watched once, so files replaced through a
+ *    rename (as most editors save) keep being reported.
+ *  - Changes are queued & collapsed until polled, so the caller decides
+ *    when to react, without a syscall per file per frame.
+ */
+class FileWatcher {
+  private:
+    /* Watched directory, with the watched files within it */
+    struct Directory {
+      std::string path;
+      std::unordered_map<std::string, std::string> files;   // File name -> Watched path
+    };
+
+    int inotify_fd;
+    int wakeup_fd;                                      // Signals the thread to stop
+    std::thread thread;
+
+    std::mutex mutex;
+    std::unordered_map<int, Directory> directories;     // Watch descriptor -> Directory
+    std::unordered_set<std::string> watched;
+    std::vector<std::string> changed;                   // Changed paths, not yet polled
+
+  private:
+    /* Thread loop, reading inotify events until stopped */
+    void run();
+
+  public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * Starts watching a file, ignored if already watched. Paths are
+     *  reported as given, lexically normalized.
+     *
+     * @param path Location of the file.
+     *
+     * @returns Whether the file is watched.
+     */
+    bool watch(const std::string &path);
+
+    /**
+     * Moves the paths changed since the last poll into changes, each once.
+     *
+     * @param changes Filled with the changed paths.
+     */
+    void poll(std::vector<std::string> &changes);
+};
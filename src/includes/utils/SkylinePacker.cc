@@ -0,0 +1,82 @@
+#include "SkylinePacker.h"
+
+#include <algorithm>
+#include <climits>
+
+SkylinePacker::SkylinePacker(int width, int height) :
+  width(width),
+  height(height),
+  skyline({ { 0, 0, width } }),
+  used_area(0) {}
+
+int SkylinePacker::fit(size_t index, int w, int h) const {
+  const int x = this->skyline[index].x;
+  if (x + w > this->width) return -1;
+
+  // Rest on the highest segment spanned by the rectangle.
+  int y = 0;
+  for (int remaining = w; remaining > 0; index++) {
+    y = std::max(y, this->skyline[index].y);
+    if (y + h > this->height) return -1;
+    remaining -= this->skyline[index].width;
+  }
+  return y;
+}
+
+void SkylinePacker::place(size_t index, int x, int y, int w, int h) {
+  this->skyline.insert(this->skyline.begin() + index, Segment{ x, y + h, w });
+
+  // Shrink or drop the segments now covered by the rectangle.
+  for (size_t i = index + 1; i < this->skyline.size(); ) {
+    Segment &segment = this->skyline[i];
+    const int covered = x + w - segment.x;
+    if (covered <= 0) break;
+
+    if (covered < segment.width) {
+      segment.x += covered;
+      segment.width -= covered;
+      break;
+    }
+    this->skyline.erase(this->skyline.begin() + i);
+  }
+
+  // Merge neighbouring segments at the same height.
+  for (size_t i = 0; i + 1 < this->skyline.size(); ) {
+    if (this->skyline[i].y == this->skyline[i + 1].y) {
+      this->skyline[i].width += this->skyline[i + 1].width;
+      this->skyline.erase(this->skyline.begin() + i + 1);
+    }
+    else i++;
+  }
+}
+
+bool SkylinePacker::pack(int w, int h, glm::ivec2 &position) {
+  if (w <= 0 || h <= 0) return false;
+
+  // Lowest top edge wins, ties go to the narrowest segment.
+  size_t best = this->skyline.size();
+  int best_top = INT_MAX, best_width = INT_MAX, best_y = 0;
+  for (size_t i = 0; i < this->skyline.size(); i++) {
+    const int y = this->fit(i, w, h);
+    if (y < 0) continue;
+
+    const int top = y + h;
+    if (top < best_top || (top == best_top && this->skyline[i].width < best_width)) {
+      best = i;
+      best_top = top;
+      best_width = this->skyline[i].width;
+      best_y = y;
+    }
+  }
+
+  if (best == this->skyline.size()) return false;
+
+  position = glm::ivec2(this->skyline[best].x, best_y);
+  this->place(best, position.x, position.y, w, h);
+  this->used_area += (size_t)w * h;
+  return true;
+}
+
+float SkylinePacker::occupancy() const {
+  return (float)this->used_area / ((float)this->width * this->height);
+}
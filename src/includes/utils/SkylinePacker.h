@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * Skyline rectangle packer, bottom-left heuristic.
+ *  - Tracks the top edge of the packed rectangles as a list of horizontal
+ *    segments, each rectangle is placed on the lowest segment it fits on.
+ *  - Wasted space below the skyline is never reclaimed, which keeps
+ *    packing linear in the number of segments. Packing the tallest
+ *    rectangles first keeps the waste low.
+ */
+class SkylinePacker {
+  private:
+    /* Horizontal segment of the skyline, at height y */
+    struct Segment {
+      int x, y, width;
+    };
+
+    int width, height;
+    std::vector<Segment> skyline;
+    size_t used_area;
+
+  private:
+    /**
+     * Returns the height a rectangle rests at when placed on the segment at
+     *  index, or -1 if it doesn't fit there.
+     */
+    int fit(size_t index, int w, int h) const;
+
+    /* Raises the skyline under a rectangle placed on the segment at index */
+    void place(size_t index, int x, int y, int w, int h);
+
+  public:
+    /**
+     * @param width Width of the packed area.
+     * @param height Height of the packed area.
+     */
+    SkylinePacker(int width, int height);
+
+    /**
+     * Finds room for a rectangle.
+     *
+     * @param w Width of the rectangle.
+     * @param h Height of the rectangle.
+     * @param position Set to the bottom-left corner of the placed rectangle.
+     *
+     * @returns Whether the rectangle fit.
+     */
+    bool pack(int w, int h, glm::ivec2 &position);
+
+    /** Returns the fraction of the area covered by packed rectangles. */
+    float occupancy() const;
+};
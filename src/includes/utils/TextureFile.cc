@@ -0,0 +1,358 @@
+#include "TextureFile.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+  /*
+   ***************************************************************
+   * Container Layouts
+   *	- Fields are little endian, as is every target we run on
+   ***************************************************************
+   */
+  constexpr uint32_t fourcc(char a, char b, char c, char d) {
+    return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+  }
+
+  constexpr uint32_t DDS_MAGIC = fourcc('D', 'D', 'S', ' ');
+
+  struct DDSPixelFormat {
+    uint32_t size, flags, fourCC, rgbBitCount;
+    uint32_t rMask, gMask, bMask, aMask;
+  };
+
+  struct DDSHeader {
+    uint32_t size, flags, height, width, pitchOrLinearSize, depth, mipMapCount;
+    uint32_t reserved1[11];
+    DDSPixelFormat format;
+    uint32_t caps, caps2, caps3, caps4, reserved2;
+  };
+
+  struct DDSHeaderDX10 {
+    uint32_t dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+  };
+  static_assert(sizeof(DDSHeader) == 124, "DDS header must be tightly packed");
+
+  // DDS flags.
+  constexpr uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000;
+  constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+  constexpr uint32_t DDPF_FOURCC = 0x4;
+  constexpr uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+  constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+  constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+  struct KTX2Header {
+    uint8_t identifier[12];
+    uint32_t vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth;
+    uint32_t layerCount, faceCount, levelCount, supercompressionScheme;
+    uint32_t dfdByteOffset, dfdByteLength, kvdByteOffset, kvdByteLength;
+    uint64_t sgdByteOffset, sgdByteLength;
+  };
+  static_assert(sizeof(KTX2Header) == 80, "KTX2 header must be tightly packed");
+
+  struct KTX2Level {
+    uint64_t byteOffset, byteLength, uncompressedByteLength;
+  };
+
+  // Data format descriptor color models.
+  constexpr uint8_t KHR_DF_MODEL_BC1A = 128, KHR_DF_MODEL_BC3 = 130, KHR_DF_MODEL_BC7 = 134;
+
+  /* Matching formats across GL, DXGI (DDS) & Vulkan (KTX2) */
+  struct FormatInfo {
+    GLenum gl;
+    uint32_t dxgi;
+    uint32_t vk;
+    uint32_t fourCC;        // Legacy DDS FourCC, 0 if a DX10 header is needed
+    size_t blockSize;
+  };
+
+  const FormatInfo FORMATS[] = {
+    { GL_COMPRESSED_RGB_S3TC_DXT1_EXT,             71, 131, fourcc('D', 'X', 'T', '1'), 8 },
+    { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,            71, 133, fourcc('D', 'X', 'T', '1'), 8 },
+    { GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,            72, 132, 0, 8 },
+    { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,      72, 134, 0, 8 },
+    { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,            77, 137, fourcc('D', 'X', 'T', '5'), 16 },
+    { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,      78, 138, 0, 16 },
+    { GL_COMPRESSED_RGBA_BPTC_UNORM,               98, 145, 0, 16 },
+    { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,         99, 146, 0, 16 },
+  };
+
+  /* Returns the first format matching the predicate, nullptr if none */
+  template <typename Predicate>
+  const FormatInfo* find_format(Predicate matches) {
+    for (const FormatInfo &info : FORMATS)
+      if (matches(info)) return &info;
+    return nullptr;
+  }
+
+  bool ends_with(const std::string &s, const char *suffix) {
+    const size_t n = strlen(suffix);
+    if (s.size() < n) return false;
+    return std::equal(s.end() - n, s.end(), suffix, [](char a, char b) { return tolower(a) == b; });
+  }
+
+  /* Fills the levels, stored back to back from data, base level first */
+  bool read_levels(const unsigned char *data, size_t size, size_t levelCount, CompressedImage &image) {
+    int w = image.width, h = image.height;
+    size_t offset = 0;
+    for (size_t i = 0; i < levelCount; i++) {
+      const size_t bytes = TextureFile::level_size(image.format, w, h);
+      if (offset + bytes > size) return false;
+
+      image.levels.push_back({ w, h, data + offset, bytes });
+      offset += bytes;
+      w = std::max(w / 2, 1);
+      h = std::max(h / 2, 1);
+    }
+    return true;
+  }
+
+  bool parse_dds(const unsigned char *data, size_t size, CompressedImage &image) {
+    if (size < 4 + sizeof(DDSHeader)) return false;
+
+    DDSHeader header;
+    memcpy(&header, data + 4, sizeof(header));
+    size_t offset = 4 + sizeof(header);
+
+    const FormatInfo *info = nullptr;
+    if (!(header.format.flags & DDPF_FOURCC)) return false;
+
+    if (header.format.fourCC == fourcc('D', 'X', '1', '0')) {
+      if (size < offset + sizeof(DDSHeaderDX10)) return false;
+
+      DDSHeaderDX10 dx10;
+      memcpy(&dx10, data + offset, sizeof(dx10));
+      offset += sizeof(dx10);
+
+      if (dx10.resourceDimension != DDS_DIMENSION_TEXTURE2D || dx10.arraySize > 1) return false;
+      // BC1 decodes the same with or without alpha, the RGBA format covers both.
+      info = find_format([&](const FormatInfo &f) { return f.dxgi == dx10.dxgiFormat && f.gl != GL_COMPRESSED_RGB_S3TC_DXT1_EXT; });
+    }
+    else {
+      info = find_format([&](const FormatInfo &f) { return f.fourCC == header.format.fourCC && f.gl != GL_COMPRESSED_RGB_S3TC_DXT1_EXT; });
+    }
+    if (!info) return false;
+
+    image.format = info->gl;
+    image.width = header.width;
+    image.height = header.height;
+    const size_t levelCount = (header.flags & DDSD_MIPMAPCOUNT) ? std::max<uint32_t>(header.mipMapCount, 1) : 1;
+    return read_levels(data + offset, size - offset, levelCount, image);
+  }
+
+  bool parse_ktx2(const unsigned char *data, size_t size, CompressedImage &image) {
+    if (size < sizeof(KTX2Header)) return false;
+
+    KTX2Header header;
+    memcpy(&header, data, sizeof(header));
+
+    // Plain 2D textures only.
+    if (header.supercompressionScheme != 0 || header.pixelDepth > 0 ||
+        header.layerCount > 1 || header.faceCount != 1)
+      return false;
+
+    const FormatInfo *info = find_format([&](const FormatInfo &f) { return f.vk == header.vkFormat; });
+    if (!info) return false;
+
+    image.format = info->gl;
+    image.width = header.pixelWidth;
+    image.height = header.pixelHeight;
+
+    // Level count of 0 asks for generated mips, only the base is stored.
+    const size_t levelCount = std::max<uint32_t>(header.levelCount, 1);
+    if (size < sizeof(header) + levelCount * sizeof(KTX2Level)) return false;
+
+    int w = image.width, h = image.height;
+    for (size_t i = 0; i < levelCount; i++) {
+      KTX2Level level;
+      memcpy(&level, data + sizeof(header) + i * sizeof(KTX2Level), sizeof(level));
+      if (level.byteOffset > size || level.byteLength > size - level.byteOffset ||
+          level.byteLength != TextureFile::level_size(image.format, w, h))
+        return false;
+
+      image.levels.push_back({ w, h, data + level.byteOffset, (size_t)level.byteLength });
+      w = std::max(w / 2, 1);
+      h = std::max(h / 2, 1);
+    }
+    return true;
+  }
+
+  bool write_dds(std::ofstream &file, const FormatInfo &info, const CompressedImage &image) {
+    DDSHeader header {};
+    header.size = sizeof(DDSHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+    header.height = image.height;
+    header.width = image.width;
+    header.pitchOrLinearSize = image.levels[0].size;
+    header.format.size = sizeof(DDSPixelFormat);
+    header.format.flags = DDPF_FOURCC;
+    header.format.fourCC = info.fourCC ? info.fourCC : fourcc('D', 'X', '1', '0');
+    header.caps = DDSCAPS_TEXTURE;
+
+    if (image.levels.size() > 1) {
+      header.flags |= DDSD_MIPMAPCOUNT;
+      header.mipMapCount = image.levels.size();
+      header.caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+
+    file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!info.fourCC) {
+      DDSHeaderDX10 dx10 { info.dxgi, DDS_DIMENSION_TEXTURE2D, 0, 1, 0 };
+      file.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+    }
+
+    for (const CompressedLevel &level : image.levels)
+      file.write(reinterpret_cast<const char*>(level.data), level.size);
+    return file.good();
+  }
+
+  /* Basic data format descriptor, one sample per block half */
+  std::vector<uint32_t> ktx2_dfd(const FormatInfo &info) {
+    const bool srgb = info.dxgi == 72 || info.dxgi == 78 || info.dxgi == 99;
+    const bool bc3 = info.dxgi == 77 || info.dxgi == 78;
+    const bool bc7 = info.dxgi == 98 || info.dxgi == 99;
+    const bool punchThrough = info.vk == 133 || info.vk == 134;
+
+    const uint8_t model = bc7 ? KHR_DF_MODEL_BC7 : bc3 ? KHR_DF_MODEL_BC3 : KHR_DF_MODEL_BC1A;
+    const uint32_t samples = bc3 ? 2 : 1;
+    const uint32_t blockSize = 24 + 16 * samples;
+
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);                                 // Total size
+    dfd.push_back(0);                                             // Khronos vendor, basic descriptor
+    dfd.push_back(2 | (blockSize << 16));                         // Version 2, block size
+    dfd.push_back(model | (1 << 8) | ((srgb ? 2u : 1u) << 16));   // BT.709 primaries, transfer
+    dfd.push_back(3 | (3 << 8));                                  // 4x4 texel blocks
+    dfd.push_back((uint32_t)info.blockSize);                      // Bytes in plane 0
+    dfd.push_back(0);
+
+    // Sample: bit offset, bit length - 1, channel, then lower & upper.
+    auto sample = [&](uint32_t offset, uint32_t bits, uint32_t channel) {
+      dfd.push_back(offset | ((bits - 1) << 16) | (channel << 24));
+      dfd.push_back(0);
+      dfd.push_back(0);
+      dfd.push_back(0xFFFFFFFF);
+    };
+    if (bc3) {
+      sample(0, 64, 15);                                          // Alpha block
+      sample(64, 64, 0);                                          // Color block
+    }
+    else {
+      sample(0, info.blockSize * 8, punchThrough ? 15 : 0);
+    }
+    return dfd;
+  }
+
+  bool write_ktx2(std::ofstream &file, const FormatInfo &info, const CompressedImage &image) {
+    const std::vector<uint32_t> dfd = ktx2_dfd(info);
+    const size_t levelCount = image.levels.size();
+
+    KTX2Header header {};
+    memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat = info.vk;
+    header.typeSize = 1;
+    header.pixelWidth = image.width;
+    header.pixelHeight = image.height;
+    header.faceCount = 1;
+    header.levelCount = levelCount;
+    header.dfdByteOffset = sizeof(KTX2Header) + levelCount * sizeof(KTX2Level);
+    header.dfdByteLength = dfd.size() * sizeof(uint32_t);
+
+    // Levels are stored smallest first, each aligned to a block.
+    std::vector<KTX2Level> index(levelCount);
+    size_t offset = header.dfdByteOffset + header.dfdByteLength;
+    for (size_t i = levelCount; i-- > 0; ) {
+      offset = (offset + info.blockSize - 1) / info.blockSize * info.blockSize;
+      index[i] = { offset, image.levels[i].size, image.levels[i].size };
+      offset += image.levels[i].size;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(KTX2Level));
+    file.write(reinterpret_cast<const char*>(dfd.data()), header.dfdByteLength);
+
+    size_t written = header.dfdByteOffset + header.dfdByteLength;
+    const char zeros[16] = {};
+    for (size_t i = levelCount; i-- > 0; ) {
+      file.write(zeros, index[i].byteOffset - written);
+      file.write(reinterpret_cast<const char*>(image.levels[i].data), image.levels[i].size);
+      written = index[i].byteOffset + image.levels[i].size;
+    }
+    return file.good();
+  }
+};
+
+
+bool TextureFile::is_compressed(const std::string &path) {
+  return ends_with(path, ".dds") || ends_with(path, ".ktx2");
+}
+
+bool TextureFile::parse(const void *data, size_t size, CompressedImage &image) {
+  const unsigned char *bytes = static_cast<const unsigned char*>(data);
+  image.levels.clear();
+
+  bool valid = false;
+  if (size >= 4 && memcmp(bytes, &DDS_MAGIC, 4) == 0)
+    valid = parse_dds(bytes, size, image);
+  else if (size >= sizeof(KTX2_IDENTIFIER) && memcmp(bytes, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0)
+    valid = parse_ktx2(bytes, size, image);
+
+  if (!valid || image.width <= 0 || image.height <= 0 || image.levels.empty()) {
+    image.levels.clear();
+    return false;
+  }
+  return true;
+}
+
+bool TextureFile::load(const std::string &path, CompressedImage &image) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    spdlog::error("TextureFile: Failed to open '{}'", path);
+    return false;
+  }
+
+  image.storage.resize(file.tellg());
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(image.storage.data()), image.storage.size());
+
+  if (!file || !parse(image.storage.data(), image.storage.size(), image)) {
+    spdlog::error("TextureFile: '{}' is not a supported DDS/KTX2 texture", path);
+    return false;
+  }
+  return true;
+}
+
+bool TextureFile::save(const std::string &path, const CompressedImage &image) {
+  const FormatInfo *info = find_format([&](const FormatInfo &f) { return f.gl == image.format; });
+  if (!info || image.levels.empty()) {
+    spdlog::error("TextureFile: Unsupported format for '{}'", path);
+    return false;
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    spdlog::error("TextureFile: Failed to open '{}'", path);
+    return false;
+  }
+
+  if (ends_with(path, ".ktx2")) return write_ktx2(file, *info, image);
+  return write_dds(file, *info, image);
+}
+
+size_t TextureFile::block_size(GLenum format) {
+  const FormatInfo *info = find_format([&](const FormatInfo &f) { return f.gl == format; });
+  return info ? info->blockSize : 0;
+}
+
+size_t TextureFile::level_size(GLenum format, int width, int height) {
+  const size_t blocksX = std::max((width + 3) / 4, 1);
+  const size_t blocksY = std::max((height + 3) / 4, 1);
+  return blocksX * blocksY * block_size(format);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/* Single mip level of a block compressed image */
+struct CompressedLevel {
+  int width, height;            // Size in texels
+  const unsigned char *data;    // Blocks, top block row first
+  size_t size;                  // Size in bytes
+};
+
+/**
+ * Block compressed image with its stored mip chain, base level first.
+ *  Levels point into storage when loaded from a file, or into the
+ *  memory given to TextureFile::parse. Move only, since levels point
+ *  into storage.
+ */
+struct CompressedImage {
+  GLenum format = 0;            // Compressed internal format (GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, ...)
+  int width = 0, height = 0;
+  std::vector<CompressedLevel> levels;
+  std::vector<unsigned char> storage;
+
+  CompressedImage() = default;
+  CompressedImage(CompressedImage&&) = default;
+  CompressedImage& operator=(CompressedImage&&) = default;
+  CompressedImage(const CompressedImage&) = delete;
+  CompressedImage& operator=(const CompressedImage&) = delete;
+};
+
+/**
+ * Pre-baked, block compressed texture containers.
+ *  - DDS, with DXT1/DXT5 FourCCs or a DX10 header
+ *  - KTX2, without supercompression
+ *
+ * Supports BC1 (RGB & RGBA), BC3 & BC7, linear or sRGB. Blocks are
+ *  stored & uploaded top row first, as both formats specify. Their
+ *  Textures are flagged so shapes sample them with v flipped (Texture::flipY).
+ */
+namespace TextureFile {
+  /**
+   * Returns whether a path names a compressed container, by extension.
+   *
+   * @param path Location of the texture.
+   */
+  bool is_compressed(const std::string &path);
+
+  /**
+   * Parses a DDS or KTX2 container in memory, without copying the blocks.
+   *  The memory must outlive the image.
+   *
+   * @param data Contents of the container.
+   * @param size Size of the contents in bytes.
+   * @param image Filled with the levels, pointing into data.
+   *
+   * @returns Whether the container is valid & supported.
+   */
+  bool parse(const void *data, size_t size, CompressedImage &image);
+
+  /**
+   * Reads & parses a DDS or KTX2 file.
+   *
+   * @param path Location of the texture.
+   * @param image Filled with the levels, pointing into its storage.
+   *
+   * @returns Whether the file is valid & supported.
+   */
+  bool load(const std::string &path, CompressedImage &image);
+
+  /**
+   * Writes an image as DDS or KTX2, picked from the path's extension.
+   *
+   * @param path Output file path.
+   * @param image Image to write.
+   *
+   * @returns Whether the file was written.
+   */
+  bool save(const std::string &path, const CompressedImage &image);
+
+  /**
+   * Returns the bytes per 4x4 block of a compressed format, 0 if unsupported.
+   *
+   * @param format Compressed internal format.
+   */
+  size_t block_size(GLenum format);
+
+  /**
+   * Returns the size in bytes of a level of the given size.
+   *
+   * @param format Compressed internal format.
+   * @param width Width of the level in texels.
+   * @param height Height of the level in texels.
+   */
+  size_t level_size(GLenum format, int width, int height);
+};
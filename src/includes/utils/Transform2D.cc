@@ -0,0 +1,247 @@
+#include "Transform2D.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define TRANSFORM_X86
+  #include <immintrin.h>
+#endif
+
+Affine2D Affine2D::from_matrix(const glm::mat4 &m) {
+  Affine2D t;
+  t.a = m[0][0];
+  t.b = m[0][1];
+  t.c = m[1][0];
+  t.d = m[1][1];
+  t.tx = m[3][0];
+  t.ty = m[3][1];
+  return t;
+}
+
+
+namespace {
+  typedef void (*PointsKernel)(const Affine2D&, const glm::vec2*, glm::vec2*, size_t);
+  typedef void (*VerticiesKernel)(const Affine2D&, const Vertex*, Vertex*, size_t);
+
+  /* Kernels in use */
+  struct Kernels {
+    Transform2D::Kernel kernel;
+    PointsKernel points;
+    VerticiesKernel verticies;
+  };
+
+
+  /*
+   ***************************************************************
+   * Scalar
+   *	- Fallback on any CPU & for the tails of the SIMD kernels
+   ***************************************************************
+   */
+  void points_scalar(const Affine2D &t, const glm::vec2 *src, glm::vec2 *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      const glm::vec2 p = src[i];
+      dst[i] = { t.a * p.x + t.c * p.y + t.tx, t.b * p.x + t.d * p.y + t.ty };
+    }
+  }
+
+  void verticies_scalar(const Affine2D &t, const Vertex *src, Vertex *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      Vertex v = src[i];
+      const float x = v.x, y = v.y;
+      v.x = t.a * x + t.c * y + t.tx;
+      v.y = t.b * x + t.d * y + t.ty;
+      dst[i] = v;
+    }
+  }
+
+
+#ifdef TRANSFORM_X86
+  /*
+   ***************************************************************
+   * SSE2
+   *	- Two points per register: [x0 y0 x1 y1]
+   *	- Two verticies are three registers, their positions are
+   *	shuffled out, transformed & shuffled back in, so every byte
+   *	is written once, in order
+   ***************************************************************
+   */
+  /* Transforms [x0 y0 x1 y1] with the broadcast columns & translation */
+  inline __m128 affine_sse(__m128 p, __m128 ab, __m128 cd, __m128 t) {
+    const __m128 xx = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+    const __m128 yy = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, ab), _mm_mul_ps(yy, cd)), t);
+  }
+
+  void points_sse2(const Affine2D &t, const glm::vec2 *src, glm::vec2 *dst, size_t count) {
+    const __m128 ab = _mm_setr_ps(t.a, t.b, t.a, t.b);
+    const __m128 cd = _mm_setr_ps(t.c, t.d, t.c, t.d);
+    const __m128 tt = _mm_setr_ps(t.tx, t.ty, t.tx, t.ty);
+
+    const float *in = &src[0].x;
+    float *out = &dst[0].x;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      const __m128 p0 = _mm_loadu_ps(in + i * 2);
+      const __m128 p1 = _mm_loadu_ps(in + i * 2 + 4);
+      _mm_storeu_ps(out + i * 2, affine_sse(p0, ab, cd, tt));
+      _mm_storeu_ps(out + i * 2 + 4, affine_sse(p1, ab, cd, tt));
+    }
+    points_scalar(t, src + i, dst + i, count - i);
+  }
+
+  void verticies_sse2(const Affine2D &t, const Vertex *src, Vertex *dst, size_t count) {
+    static_assert(sizeof(Vertex) == 6 * sizeof(float) && offsetof(Vertex, x) == 0 && offsetof(Vertex, y) == 4,
+      "SIMD kernels expect positions at the start of 24 byte verticies");
+
+    const __m128 ab = _mm_setr_ps(t.a, t.b, t.a, t.b);
+    const __m128 cd = _mm_setr_ps(t.c, t.d, t.c, t.d);
+    const __m128 tt = _mm_setr_ps(t.tx, t.ty, t.tx, t.ty);
+
+    const float *in = &src[0].x;
+    float *out = &dst[0].x;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+      // [x0 y0 z0 c0] [u0 v0 x1 y1] [z1 c1 u1 v1]
+      const __m128 l0 = _mm_loadu_ps(in + i * 6);
+      const __m128 l1 = _mm_loadu_ps(in + i * 6 + 4);
+      const __m128 l2 = _mm_loadu_ps(in + i * 6 + 8);
+
+      const __m128 r = affine_sse(_mm_shuffle_ps(l0, l1, _MM_SHUFFLE(3, 2, 1, 0)), ab, cd, tt);
+      _mm_storeu_ps(out + i * 6, _mm_shuffle_ps(r, l0, _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(out + i * 6 + 4, _mm_shuffle_ps(l1, r, _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(out + i * 6 + 8, l2);
+    }
+    verticies_scalar(t, src + i, dst + i, count - i);
+  }
+
+
+  /*
+   ***************************************************************
+   * AVX2 & FMA
+   *	- Four points per register
+   *	- Verticies go two pairs at a time, as in the SSE2 kernel,
+   *	sharing a single 256-bit transform
+   ***************************************************************
+   */
+  __attribute__((target("avx2,fma")))
+  inline __m256 affine_avx(__m256 p, __m256 ab, __m256 cd, __m256 t) {
+    const __m256 xx = _mm256_moveldup_ps(p);
+    const __m256 yy = _mm256_movehdup_ps(p);
+    return _mm256_fmadd_ps(xx, ab, _mm256_fmadd_ps(yy, cd, t));
+  }
+
+  __attribute__((target("avx2,fma")))
+  void points_avx2(const Affine2D &t, const glm::vec2 *src, glm::vec2 *dst, size_t count) {
+    const __m256 ab = _mm256_setr_ps(t.a, t.b, t.a, t.b, t.a, t.b, t.a, t.b);
+    const __m256 cd = _mm256_setr_ps(t.c, t.d, t.c, t.d, t.c, t.d, t.c, t.d);
+    const __m256 tt = _mm256_setr_ps(t.tx, t.ty, t.tx, t.ty, t.tx, t.ty, t.tx, t.ty);
+
+    const float *in = &src[0].x;
+    float *out = &dst[0].x;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      const __m256 p0 = _mm256_loadu_ps(in + i * 2);
+      const __m256 p1 = _mm256_loadu_ps(in + i * 2 + 8);
+      _mm256_storeu_ps(out + i * 2, affine_avx(p0, ab, cd, tt));
+      _mm256_storeu_ps(out + i * 2 + 8, affine_avx(p1, ab, cd, tt));
+    }
+    points_scalar(t, src + i, dst + i, count - i);
+  }
+
+  __attribute__((target("avx2,fma")))
+  void verticies_avx2(const Affine2D &t, const Vertex *src, Vertex *dst, size_t count) {
+    const __m256 ab = _mm256_setr_ps(t.a, t.b, t.a, t.b, t.a, t.b, t.a, t.b);
+    const __m256 cd = _mm256_setr_ps(t.c, t.d, t.c, t.d, t.c, t.d, t.c, t.d);
+    const __m256 tt = _mm256_setr_ps(t.tx, t.ty, t.tx, t.ty, t.tx, t.ty, t.tx, t.ty);
+
+    const float *in = &src[0].x;
+    float *out = &dst[0].x;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      const float *s = in + i * 6;
+      float *d = out + i * 6;
+
+      const __m128 l0 = _mm_loadu_ps(s), l1 = _mm_loadu_ps(s + 4), l2 = _mm_loadu_ps(s + 8);
+      const __m128 l3 = _mm_loadu_ps(s + 12), l4 = _mm_loadu_ps(s + 16), l5 = _mm_loadu_ps(s + 20);
+
+      // Positions of both pairs: [x0 y0 x1 y1 | x2 y2 x3 y3]
+      const __m256 p = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm_shuffle_ps(l0, l1, _MM_SHUFFLE(3, 2, 1, 0))),
+        _mm_shuffle_ps(l3, l4, _MM_SHUFFLE(3, 2, 1, 0)),
+        1
+      );
+      const __m256 r = affine_avx(p, ab, cd, tt);
+      const __m128 r0 = _mm256_castps256_ps128(r);
+      const __m128 r1 = _mm256_extractf128_ps(r, 1);
+
+      _mm_storeu_ps(d, _mm_shuffle_ps(r0, l0, _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(d + 4, _mm_shuffle_ps(l1, r0, _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(d + 8, l2);
+      _mm_storeu_ps(d + 12, _mm_shuffle_ps(r1, l3, _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(d + 16, _mm_shuffle_ps(l4, r1, _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(d + 20, l5);
+    }
+    verticies_scalar(t, src + i, dst + i, count - i);
+  }
+#endif
+
+
+  Kernels make_kernels(Transform2D::Kernel kernel) {
+    switch (kernel) {
+#ifdef TRANSFORM_X86
+      case Transform2D::Kernel::AVX2: return { kernel, points_avx2, verticies_avx2 };
+      case Transform2D::Kernel::SSE2: return { kernel, points_sse2, verticies_sse2 };
+#endif
+      default: return { Transform2D::Kernel::Scalar, points_scalar, verticies_scalar };
+    }
+  }
+
+  /* Kernels in use, the fastest supported until set_kernel() */
+  Kernels& active() {
+    static Kernels kernels = make_kernels(
+      Transform2D::is_supported(Transform2D::Kernel::AVX2) ? Transform2D::Kernel::AVX2 :
+      Transform2D::is_supported(Transform2D::Kernel::SSE2) ? Transform2D::Kernel::SSE2 :
+      Transform2D::Kernel::Scalar
+    );
+    return kernels;
+  }
+};
+
+
+namespace Transform2D {
+  void points(const Affine2D &t, const glm::vec2 *src, glm::vec2 *dst, size_t count) {
+    active().points(t, src, dst, count);
+  }
+
+  void verticies(const Affine2D &t, const Vertex *src, Vertex *dst, size_t count) {
+    active().verticies(t, src, dst, count);
+  }
+
+  bool is_supported(Kernel kernel) {
+    switch (kernel) {
+      case Kernel::Scalar: return true;
+#ifdef TRANSFORM_X86
+      case Kernel::SSE2: return __builtin_cpu_supports("sse2");
+      case Kernel::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+      default: return false;
+    }
+  }
+
+  bool set_kernel(Kernel kernel) {
+    if (!is_supported(kernel)) return false;
+    active() = make_kernels(kernel);
+    return true;
+  }
+
+  Kernel get_kernel() {
+    return active().kernel;
+  }
+
+  const char* kernel_name(Kernel kernel) {
+    switch (kernel) {
+      case Kernel::Scalar: return "scalar";
+      case Kernel::SSE2: return "sse2";
+      case Kernel::AVX2: return "avx2";
+    }
+    return "unknown";
+  }
+};
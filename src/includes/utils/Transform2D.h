@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <stddef.h>
+
+// Project Libraries
+#include "BufferData.h"
+
+/**
+ * 2D affine transform, the 2x3 part of a model matrix acting on x & y:
+ *  x' = a * x + c * y + tx
+ *  y' = b * x + d * y + ty
+ */
+struct Affine2D {
+  float a = 1.f, b = 0.f;     // First column
+  float c = 0.f, d = 1.f;     // Second column
+  float tx = 0.f, ty = 0.f;   // Translation
+
+  /**
+   * Takes the 2D part of a model matrix. Exact for the matrices built by
+   * Shape, which rotate around z & leave z untouched.
+   *
+   * @param m Model matrix.
+   */
+  static Affine2D from_matrix(const glm::mat4 &m);
+
+  /** Transforms a single point. */
+  glm::vec2 apply(const glm::vec2 &p) const {
+    return { this->a * p.x + this->c * p.y + this->tx, this->b * p.x + this->d * p.y + this->ty };
+  }
+};
+
+/**
+ * Batch affine transforms over contiguous position streams.
+ *  - SSE2 & AVX2/FMA kernels with a scalar fallback, picked at runtime
+ *    from the CPU's features
+ *  - Streams are read & written in order, whole verticies at a time, so
+ *    the output can be write-combined (mapped GL buffers) & transforms
+ *    run at memory bandwidth
+ *  - Sources & destinations may be the same, for transforms in place
+ */
+namespace Transform2D {
+  enum class Kernel {
+    Scalar,
+    SSE2,
+    AVX2,
+  };
+
+  /**
+   * Transforms points.
+   *
+   * @param t Transform to apply.
+   * @param src Points to transform.
+   * @param dst Transformed points, may be src.
+   * @param count Number of points.
+   */
+  void points(const Affine2D &t, const glm::vec2 *src, glm::vec2 *dst, size_t count);
+
+  /**
+   * Copies verticies, transforming their x & y. Other attributes, z
+   * included, are copied untouched.
+   *
+   * @param t Transform to apply.
+   * @param src Verticies to transform.
+   * @param dst Transformed verticies, may be src.
+   * @param count Number of verticies.
+   */
+  void verticies(const Affine2D &t, const Vertex *src, Vertex *dst, size_t count);
+
+  /** Returns whether the CPU supports the kernel. */
+  bool is_supported(Kernel);
+
+  /**
+   * Selects the kernels used, e.g. to compare them. Defaults to the
+   * fastest supported.
+   *
+   * @param kernel Kernel to use.
+   * @returns False if the CPU doesn't support it, leaving the current one.
+   */
+  bool set_kernel(Kernel);
+
+  /** Returns the kernel in use. */
+  Kernel get_kernel();
+
+  /** Returns the name of a kernel. */
+  const char* kernel_name(Kernel);
+};
@@ -0,0 +1,1168 @@
+#include "Triangulate.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <set>
+#include <glm/gtc/constants.hpp>
+
+/* Point count above which ear tests use the z-order hash */
+#define HASH_THRESHOLD 80
+
+/* Point count above which simple polygons are swept instead of ear clipped */
+#define MONOTONE_THRESHOLD 256
+
+namespace {
+  /* Vertex within a ring, linked both in ring order & z-order */
+  struct Node {
+    GLuint i;                 // Index into the input points.
+    double x, y;
+    Node *prev = nullptr;     // Ring order.
+    Node *next = nullptr;
+    int32_t z = 0;            // Z-order curve value.
+    Node *prevZ = nullptr;    // Z-order.
+    Node *nextZ = nullptr;
+    bool steiner = false;     // Single point hole, never filtered out.
+
+    Node(GLuint i, double x, double y): i(i), x(x), y(y) {}
+  };
+
+  /* State of a single triangulation */
+  struct Context {
+    std::deque<Node> nodes;           // Node storage, addresses stay valid on growth.
+    std::vector<GLuint> &triangles;   // Output indicies.
+    double minX = 0.0, minY = 0.0;
+    double invSize = 0.0;             // Z-order scale, 0 when hashing is off.
+
+    Context(std::vector<GLuint> &triangles): triangles(triangles) {}
+
+    Node* create(GLuint i, double x, double y) {
+      this->nodes.emplace_back(i, x, y);
+      return &this->nodes.back();
+    }
+  };
+
+
+  /*
+   ***************************************************************
+   * Geometry Predicates
+   ***************************************************************
+   */
+  /* Twice the signed area of the triangle, negative for counter-clockwise in y-up */
+  inline double area(const Node *p, const Node *q, const Node *r) {
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+  }
+
+  inline bool equals(const Node *a, const Node *b) {
+    return a->x == b->x && a->y == b->y;
+  }
+
+  inline int sign(double v) {
+    return (v > 0.0) - (v < 0.0);
+  }
+
+  inline bool point_in_triangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+           (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+  }
+
+  /* For collinear p, q, r: whether q lies on segment pr */
+  inline bool on_segment(const Node *p, const Node *q, const Node *r) {
+    return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+           q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+  }
+
+  bool intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2) {
+    const int o1 = sign(area(p1, q1, p2));
+    const int o2 = sign(area(p1, q1, q2));
+    const int o3 = sign(area(p2, q2, p1));
+    const int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4) return true;
+    if (o1 == 0 && on_segment(p1, p2, q1)) return true;
+    if (o2 == 0 && on_segment(p1, q2, q1)) return true;
+    if (o3 == 0 && on_segment(p2, p1, q2)) return true;
+    if (o4 == 0 && on_segment(p2, q1, q2)) return true;
+    return false;
+  }
+
+  /* Whether the diagonal ab intersects any edge of the ring */
+  bool intersects_polygon(const Node *a, const Node *b) {
+    const Node *p = a;
+    do {
+      if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+          intersects(p, p->next, a, b))
+        return true;
+      p = p->next;
+    } while (p != a);
+    return false;
+  }
+
+  /* Whether the diagonal ab starts inside the polygon at a */
+  inline bool locally_inside(const Node *a, const Node *b) {
+    return area(a->prev, a, a->next) < 0.0
+      ? area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0
+      : area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0;
+  }
+
+  /* Whether the middle of the diagonal ab is inside the polygon */
+  bool middle_inside(const Node *a, const Node *b) {
+    const Node *p = a;
+    bool inside = false;
+    const double px = (a->x + b->x) / 2.0;
+    const double py = (a->y + b->y) / 2.0;
+    do {
+      if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+          (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+        inside = !inside;
+      p = p->next;
+    } while (p != a);
+    return inside;
+  }
+
+  /* Whether a diagonal between a & b splits the polygon into two valid ones */
+  bool is_valid_diagonal(const Node *a, const Node *b) {
+    return a->next->i != b->i && a->prev->i != b->i && !intersects_polygon(a, b) &&
+      ((locally_inside(a, b) && locally_inside(b, a) && middle_inside(a, b) &&
+        (area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0)) ||
+       (equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0));
+  }
+
+  /* Whether the sector at m contains the sector at p */
+  inline bool sector_contains_sector(const Node *m, const Node *p) {
+    return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0;
+  }
+
+
+  /*
+   ***************************************************************
+   * Linked Ring
+   ***************************************************************
+   */
+  Node* insert_node(Context &ctx, GLuint i, double x, double y, Node *last) {
+    Node *p = ctx.create(i, x, y);
+    if (!last) {
+      p->prev = p;
+      p->next = p;
+    } else {
+      p->next = last->next;
+      p->prev = last;
+      last->next->prev = p;
+      last->next = p;
+    }
+    return p;
+  }
+
+  void remove_node(Node *p) {
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+    if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+    if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+  }
+
+  double signed_area(const std::vector<glm::vec2> &points, size_t start, size_t end) {
+    double sum = 0.0;
+    for (size_t i = start, j = end - 1; i < end; j = i++)
+      sum += ((double)points[j].x - points[i].x) * ((double)points[i].y + points[j].y);
+    return sum;
+  }
+
+  /* Links the points [start, end) into a ring, in the requested winding */
+  Node* linked_list(Context &ctx, const std::vector<glm::vec2> &points, size_t start, size_t end, bool clockwise) {
+    Node *last = nullptr;
+    if (start >= end) return last;
+
+    if (clockwise == (signed_area(points, start, end) > 0.0)) {
+      for (size_t i = start; i < end; i++)
+        last = insert_node(ctx, i, points[i].x, points[i].y, last);
+    } else {
+      for (size_t i = end; i-- > start;)
+        last = insert_node(ctx, i, points[i].x, points[i].y, last);
+    }
+
+    // Closing point duplicating the first.
+    if (last && equals(last, last->next)) {
+      Node *next = last->next;
+      remove_node(last);
+      last = next;
+    }
+
+    return last;
+  }
+
+  /* Removes duplicate & collinear points, returning a node still in the ring */
+  Node* filter_points(Node *start, Node *end = nullptr) {
+    if (!start) return start;
+    if (!end) end = start;
+
+    Node *p = start;
+    bool again;
+    do {
+      again = false;
+      if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0)) {
+        remove_node(p);
+        p = end = p->prev;
+        if (p == p->next) break;
+        again = true;
+      } else {
+        p = p->next;
+      }
+    } while (again || p != end);
+
+    return end;
+  }
+
+  /**
+   * Links a & b with a bridge, splitting the ring in two. When a & b are on
+   * different rings, the result is a single ring instead.
+   */
+  Node* split_polygon(Context &ctx, Node *a, Node *b) {
+    Node *a2 = ctx.create(a->i, a->x, a->y);
+    Node *b2 = ctx.create(b->i, b->x, b->y);
+    Node *an = a->next;
+    Node *bp = b->prev;
+
+    a->next = b;
+    b->prev = a;
+
+    a2->next = an;
+    an->prev = a2;
+
+    b2->next = a2;
+    a2->prev = b2;
+
+    bp->next = b2;
+    b2->prev = bp;
+
+    return b2;
+  }
+
+
+  /*
+   ***************************************************************
+   * Z-Order Hashing
+   *	- Interleaves the scaled coordinates so that points close on
+   *	the curve are close in space
+   ***************************************************************
+   */
+  int32_t z_order(double x, double y, double minX, double minY, double invSize) {
+    uint32_t ix = (uint32_t)((x - minX) * invSize);
+    uint32_t iy = (uint32_t)((y - minY) * invSize);
+
+    ix = (ix | (ix << 8)) & 0x00FF00FF;
+    ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+    ix = (ix | (ix << 2)) & 0x33333333;
+    ix = (ix | (ix << 1)) & 0x55555555;
+
+    iy = (iy | (iy << 8)) & 0x00FF00FF;
+    iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+    iy = (iy | (iy << 2)) & 0x33333333;
+    iy = (iy | (iy << 1)) & 0x55555555;
+
+    return (int32_t)(ix | (iy << 1));
+  }
+
+  /* Bottom-up merge sort of the z-order list */
+  Node* sort_linked(Node *list) {
+    size_t inSize = 1;
+    size_t numMerges;
+
+    do {
+      Node *p = list;
+      Node *tail = nullptr;
+      list = nullptr;
+      numMerges = 0;
+
+      while (p) {
+        numMerges++;
+        Node *q = p;
+        size_t pSize = 0;
+        for (size_t i = 0; i < inSize; i++) {
+          pSize++;
+          q = q->nextZ;
+          if (!q) break;
+        }
+
+        size_t qSize = inSize;
+        while (pSize > 0 || (qSize > 0 && q)) {
+          Node *e;
+          if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z)) {
+            e = p;
+            p = p->nextZ;
+            pSize--;
+          } else {
+            e = q;
+            q = q->nextZ;
+            qSize--;
+          }
+
+          if (tail) tail->nextZ = e;
+          else list = e;
+
+          e->prevZ = tail;
+          tail = e;
+        }
+
+        p = q;
+      }
+
+      tail->nextZ = nullptr;
+      inSize *= 2;
+    } while (numMerges > 1);
+
+    return list;
+  }
+
+  void index_curve(Context &ctx, Node *start) {
+    Node *p = start;
+    do {
+      if (p->z == 0) p->z = z_order(p->x, p->y, ctx.minX, ctx.minY, ctx.invSize);
+      p->prevZ = p->prev;
+      p->nextZ = p->next;
+      p = p->next;
+    } while (p != start);
+
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+    sort_linked(p);
+  }
+
+
+  /*
+   ***************************************************************
+   * Ear Clipping
+   ***************************************************************
+   */
+  /* Whether the triangle around ear contains no other point of the ring */
+  bool is_ear(const Node *ear) {
+    const Node *a = ear->prev, *b = ear, *c = ear->next;
+    if (area(a, b, c) >= 0.0) return false;   // Reflex, can't be an ear.
+
+    const double x0 = std::min({ a->x, b->x, c->x }), y0 = std::min({ a->y, b->y, c->y });
+    const double x1 = std::max({ a->x, b->x, c->x }), y1 = std::max({ a->y, b->y, c->y });
+
+    const Node *p = c->next;
+    while (p != a) {
+      if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+          point_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+          area(p->prev, p, p->next) >= 0.0)
+        return false;
+      p = p->next;
+    }
+
+    return true;
+  }
+
+  /* Same as is_ear, only visiting points within the triangle's z-order range */
+  bool is_ear_hashed(const Context &ctx, const Node *ear) {
+    const Node *a = ear->prev, *b = ear, *c = ear->next;
+    if (area(a, b, c) >= 0.0) return false;
+
+    const double x0 = std::min({ a->x, b->x, c->x }), y0 = std::min({ a->y, b->y, c->y });
+    const double x1 = std::max({ a->x, b->x, c->x }), y1 = std::max({ a->y, b->y, c->y });
+    const int32_t minZ = z_order(x0, y0, ctx.minX, ctx.minY, ctx.invSize);
+    const int32_t maxZ = z_order(x1, y1, ctx.minX, ctx.minY, ctx.invSize);
+
+    auto blocks = [&](const Node *p) {
+      return p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c &&
+        point_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+        area(p->prev, p, p->next) >= 0.0;
+    };
+
+    // Walk both directions of the z-order at once.
+    const Node *p = ear->prevZ;
+    const Node *n = ear->nextZ;
+    while (p && p->z >= minZ && n && n->z <= maxZ) {
+      if (blocks(p)) return false;
+      p = p->prevZ;
+      if (blocks(n)) return false;
+      n = n->nextZ;
+    }
+
+    for (; p && p->z >= minZ; p = p->prevZ)
+      if (blocks(p)) return false;
+
+    for (; n && n->z <= maxZ; n = n->nextZ)
+      if (blocks(n)) return false;
+
+    return true;
+  }
+
+  /* Clips triangles around small self-intersections, a-p-p.next-b crossing */
+  Node* cure_local_intersections(Context &ctx, Node *start) {
+    Node *p = start;
+    do {
+      Node *a = p->prev;
+      Node *b = p->next->next;
+
+      if (!equals(a, b) && intersects(a, p, p->next, b) && locally_inside(a, b) && locally_inside(b, a)) {
+        ctx.triangles.push_back(a->i);
+        ctx.triangles.push_back(p->i);
+        ctx.triangles.push_back(b->i);
+
+        remove_node(p);
+        remove_node(p->next);
+        p = start = b;
+      }
+      p = p->next;
+    } while (p != start);
+
+    return filter_points(p);
+  }
+
+  void earcut_linked(Context &ctx, Node *ear, int pass);
+
+  /* Splits the ring along a valid diagonal & triangulates both halves */
+  void split_earcut(Context &ctx, Node *start) {
+    Node *a = start;
+    do {
+      Node *b = a->next->next;
+      while (b != a->prev) {
+        if (a->i != b->i && is_valid_diagonal(a, b)) {
+          Node *c = split_polygon(ctx, a, b);
+
+          a = filter_points(a, a->next);
+          c = filter_points(c, c->next);
+
+          earcut_linked(ctx, a, 0);
+          earcut_linked(ctx, c, 0);
+          return;
+        }
+        b = b->next;
+      }
+      a = a->next;
+    } while (a != start);
+  }
+
+  /**
+   * Clips ears until the ring is exhausted. When no ear is left, retries
+   * after filtering points (pass 1), curing local intersections (pass 2), then
+   * by splitting the ring in two.
+   */
+  void earcut_linked(Context &ctx, Node *ear, int pass) {
+    if (!ear) return;
+    if (!pass && ctx.invSize != 0.0) index_curve(ctx, ear);
+
+    Node *stop = ear;
+    while (ear->prev != ear->next) {
+      Node *prev = ear->prev;
+      Node *next = ear->next;
+
+      if (ctx.invSize != 0.0 ? is_ear_hashed(ctx, ear) : is_ear(ear)) {
+        ctx.triangles.push_back(prev->i);
+        ctx.triangles.push_back(ear->i);
+        ctx.triangles.push_back(next->i);
+        remove_node(ear);
+
+        // Skipping the next vertex leads to less sliver triangles.
+        ear = next->next;
+        stop = next->next;
+        continue;
+      }
+
+      ear = next;
+
+      // Looped through the whole ring without finding an ear.
+      if (ear == stop) {
+        if (pass == 0) {
+          earcut_linked(ctx, filter_points(ear), 1);
+        } else if (pass == 1) {
+          ear = cure_local_intersections(ctx, filter_points(ear));
+          earcut_linked(ctx, ear, 2);
+        } else {
+          split_earcut(ctx, ear);
+        }
+        break;
+      }
+    }
+  }
+
+
+  /*
+   ***************************************************************
+   * Holes
+   *	- Each hole is bridged to the outer ring, from its leftmost
+   *	point, turning the polygon into a single ring
+   ***************************************************************
+   */
+  Node* get_leftmost(Node *start) {
+    Node *p = start, *leftmost = start;
+    do {
+      if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+        leftmost = p;
+      p = p->next;
+    } while (p != start);
+    return leftmost;
+  }
+
+  /* Finds a point of the outer ring visible from the hole's leftmost point */
+  Node* find_hole_bridge(Node *hole, Node *outer) {
+    Node *p = outer;
+    const double hx = hole->x;
+    const double hy = hole->y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node *m = nullptr;
+
+    // Segment intersected by a ray cast left from the hole, closest to it.
+    do {
+      if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+        const double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+        if (x <= hx && x > qx) {
+          qx = x;
+          m = p->x < p->next->x ? p : p->next;
+          if (x == hx) return m;   // Hole touches the outer segment.
+        }
+      }
+      p = p->next;
+    } while (p != outer);
+
+    if (!m) return nullptr;
+
+    // Points inside the triangle of hole point, segment intersection & endpoint
+    // may block the bridge, pick the one with the minimum angle instead.
+    const Node *stop = m;
+    const double mx = m->x;
+    const double my = m->y;
+    double tanMin = std::numeric_limits<double>::infinity();
+
+    p = m;
+    do {
+      if (hx >= p->x && p->x >= mx && hx != p->x &&
+          point_in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+        const double tan = std::abs(hy - p->y) / (hx - p->x);
+
+        if (locally_inside(p, hole) &&
+            (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sector_contains_sector(m, p)))))) {
+          m = p;
+          tanMin = tan;
+        }
+      }
+      p = p->next;
+    } while (p != stop);
+
+    return m;
+  }
+
+  Node* eliminate_hole(Context &ctx, Node *hole, Node *outer) {
+    Node *bridge = find_hole_bridge(hole, outer);
+    if (!bridge) return outer;
+
+    Node *bridgeReverse = split_polygon(ctx, bridge, hole);
+    filter_points(bridgeReverse, bridgeReverse->next);
+    return filter_points(bridge, bridge->next);
+  }
+
+  Node* eliminate_holes(Context &ctx, const std::vector<glm::vec2> &points, const std::vector<size_t> &holes, Node *outer) {
+    std::vector<Node*> queue;
+    queue.reserve(holes.size());
+
+    for (size_t h = 0; h < holes.size(); h++) {
+      const size_t start = holes[h];
+      const size_t end = h + 1 < holes.size() ? holes[h + 1] : points.size();
+
+      Node *list = linked_list(ctx, points, start, end, false);
+      if (!list) continue;
+      if (list == list->next) list->steiner = true;
+      queue.push_back(get_leftmost(list));
+    }
+
+    // Bridge holes from left to right.
+    std::sort(queue.begin(), queue.end(), [](const Node *a, const Node *b) {
+      return a->x < b->x;
+    });
+
+    for (Node *hole : queue)
+      outer = eliminate_hole(ctx, hole, outer);
+
+    return outer;
+  }
+
+
+  /*
+   ***************************************************************
+   * Monotone Partition
+   *	- Simple polygons are swept top to bottom, adding diagonals
+   *	at split & merge points so every piece is y-monotone, then
+   *	each piece is triangulated with a stack
+   *	- O(n log n) whatever the shape, where ear tests degrade on
+   *	long thin ears whose bounds cover most of the ring
+   ***************************************************************
+   */
+  /* Point of a ring, linked in ring order with the interior on the left */
+  struct RingPoint {
+    GLuint i;             // Index into the input points.
+    double x, y;
+    GLuint prev, next;
+  };
+
+  enum class PointType { Start, End, Split, Merge, Regular };
+
+  /* Point in sweep order, sorted by value so sorts stay in cache */
+  struct SweepEvent {
+    double y, x;
+    GLuint id;
+
+    /* Higher first, or as high & further left */
+    bool operator<(const SweepEvent &o) const { return this->y > o.y || (this->y == o.y && this->x < o.x); }
+  };
+
+  /* Whether a comes before b in sweep order: higher, or as high & further left */
+  inline bool above(const RingPoint &a, const RingPoint &b) {
+    return a.y > b.y || (a.y == b.y && a.x < b.x);
+  }
+
+  /* Twice the signed area of pqr, positive for a left turn */
+  inline double turn(const RingPoint &p, const RingPoint &q, const RingPoint &r) {
+    return (q.x - p.x) * (r.y - q.y) - (q.y - p.y) * (r.x - q.x);
+  }
+
+  /* Collects the points [start, end) of a ring, skipping repeats & the closing duplicate */
+  void ring_points(const std::vector<glm::vec2> &points, size_t start, size_t end, std::vector<GLuint> &ring) {
+    ring.clear();
+    for (size_t i = start; i < end; i++)
+      if (ring.empty() || points[i] != points[ring.back()]) ring.push_back(i);
+
+    while (ring.size() > 1 && points[ring.back()] == points[ring.front()]) ring.pop_back();
+  }
+
+  /* Edge going down from point e, copied so comparisons stay within the tree */
+  struct StatusEdge {
+    double ax, ay, bx, by;
+    GLuint e;
+  };
+
+  /* Edges crossed by the sweep line, ordered left to right */
+  class SweepStatus {
+    private:
+      /* Orders edges by their x at the sweep line, or against a query x */
+      struct Order {
+        typedef void is_transparent;
+        const SweepStatus *status;
+        bool operator()(const StatusEdge &e, const StatusEdge &f) const { return status->x_at(e) < status->x_at(f); }
+        bool operator()(const StatusEdge &e, double x) const { return status->x_at(e) < x; }
+        bool operator()(double x, const StatusEdge &e) const { return x < status->x_at(e); }
+      };
+
+      const std::vector<RingPoint> &points;
+      double y = 0.0, x = 0.0;        // Sweep line & query point.
+
+    public:
+      static constexpr GLuint NONE = std::numeric_limits<GLuint>::max();
+      typedef std::set<StatusEdge, Order> Edges;
+      Edges edges;
+
+      SweepStatus(const std::vector<RingPoint> &points): points(points), edges(Order { this }) {}
+
+      double x_at(const StatusEdge &e) const {
+        if (this->y >= e.ay) return e.ax;
+        if (this->y <= e.by) return e.bx;
+        return e.ax + (this->y - e.ay) * (e.bx - e.ax) / (e.by - e.ay);
+      }
+
+      void move_to(const RingPoint &p) {
+        this->y = p.y;
+        this->x = p.x;
+      }
+
+      /* Inserts the edge going down from point e */
+      Edges::iterator insert(GLuint e) {
+        const RingPoint &a = this->points[e], &b = this->points[a.next];
+        return this->edges.insert({ a.x, a.y, b.x, b.y, e }).first;
+      }
+
+      /* Edge directly left of the point moved to, NONE if there is none */
+      GLuint left_of() const {
+        auto it = this->edges.lower_bound(this->x);
+        return it == this->edges.begin() ? NONE : (--it)->e;
+      }
+  };
+
+  /* First edge leaving v clockwise from the direction back to u, v's edges in [first, last) */
+  size_t next_edge(const std::vector<RingPoint> &points, const std::vector<GLuint> &targets, size_t first, size_t last, GLuint u, GLuint v) {
+    if (last - first == 1) return first;
+
+    const RingPoint &o = points[v];
+    const double dx = points[u].x - o.x, dy = points[u].y - o.y;
+
+    // Angle groups clockwise from (dx, dy): (0, pi), pi, (pi, 2pi), 2pi.
+    auto group = [&](double x, double y) {
+      const double cross = dx * y - dy * x;
+      if (cross < 0.0) return 0;
+      if (cross > 0.0) return 2;
+      return dx * x + dy * y < 0.0 ? 1 : 3;
+    };
+
+    size_t best = first;
+    int bestGroup = 4;
+    double bx = 0.0, by = 0.0;
+    for (size_t s = first; s < last; s++) {
+      const double x = points[targets[s]].x - o.x, y = points[targets[s]].y - o.y;
+      const int g = group(x, y);
+      if (g < bestGroup || (g == bestGroup && bx * y - by * x > 0.0)) {
+        best = s;
+        bestGroup = g;
+        bx = x;
+        by = y;
+      }
+    }
+    return best;
+  }
+
+  /* Triangulates a y-monotone piece, given in ring order */
+  void triangulate_monotone(const std::vector<RingPoint> &points, const std::vector<GLuint> &piece,
+                            std::vector<std::pair<GLuint, bool>> &sorted, std::vector<std::pair<GLuint, bool>> &stack,
+                            std::vector<GLuint> &triangles) {
+    const size_t m = piece.size();
+    auto emit = [&](GLuint a, GLuint b, GLuint c) {
+      triangles.push_back(points[a].i);
+      triangles.push_back(points[b].i);
+      triangles.push_back(points[c].i);
+    };
+    if (m < 3) return;
+    if (m == 3) {
+      emit(piece[0], piece[1], piece[2]);
+      return;
+    }
+
+    size_t top = 0, bottom = 0;
+    for (size_t k = 1; k < m; k++) {
+      if (above(points[piece[k]], points[piece[top]])) top = k;
+      if (above(points[piece[bottom]], points[piece[k]])) bottom = k;
+    }
+
+    // Merge the chains, the left one runs forward from the top.
+    sorted.clear();
+    sorted.push_back({ piece[top], true });
+    size_t l = (top + 1) % m, r = (top + m - 1) % m;
+    while (sorted.size() < m) {
+      const bool left = r == bottom || (l != (bottom + 1) % m && above(points[piece[l]], points[piece[r]]));
+      if (left) {
+        sorted.push_back({ piece[l], true });
+        l = (l + 1) % m;
+      } else {
+        sorted.push_back({ piece[r], false });
+        r = (r + m - 1) % m;
+      }
+    }
+
+    // Ears of the same chain are convex toward the interior.
+    auto convex = [&](GLuint u, GLuint last, GLuint prior, bool left) {
+      return left ? turn(points[prior], points[last], points[u]) > 0.0 : turn(points[u], points[last], points[prior]) > 0.0;
+    };
+
+    stack.assign(sorted.begin(), sorted.begin() + 2);
+    for (size_t k = 2; k + 1 < m; k++) {
+      const std::pair<GLuint, bool> u = sorted[k];
+      if (u.second != stack.back().second) {
+        while (stack.size() > 1) {
+          const GLuint t = stack.back().first;
+          stack.pop_back();
+          emit(u.first, t, stack.back().first);
+        }
+        stack.clear();
+        stack.push_back(sorted[k - 1]);
+        stack.push_back(u);
+      } else {
+        std::pair<GLuint, bool> last = stack.back();
+        stack.pop_back();
+        while (!stack.empty() && convex(u.first, last.first, stack.back().first, u.second)) {
+          emit(u.first, last.first, stack.back().first);
+          last = stack.back();
+          stack.pop_back();
+        }
+        stack.push_back(last);
+        stack.push_back(u);
+      }
+    }
+
+    const GLuint u = sorted[m - 1].first;
+    while (stack.size() > 1) {
+      const GLuint t = stack.back().first;
+      stack.pop_back();
+      emit(u, t, stack.back().first);
+    }
+  }
+
+  /**
+   * Triangulates a simple polygon through a monotone partition.
+   *  Returns false when the sweep finds the input isn't simple after all.
+   */
+  bool monotone_partition(const std::vector<glm::vec2> &points, const std::vector<size_t> &holes, std::vector<GLuint> &triangles) {
+    // Link the rings, outer counter-clockwise & holes clockwise.
+    std::vector<RingPoint> ring;
+    ring.reserve(points.size());
+    std::vector<GLuint> indicies;
+    for (size_t r = 0; r <= holes.size(); r++) {
+      const size_t start = r == 0 ? 0 : holes[r - 1];
+      const size_t end = r < holes.size() ? holes[r] : points.size();
+
+      ring_points(points, start, end, indicies);
+      if (indicies.size() < 3) {
+        if (r == 0) return true;
+        continue;
+      }
+
+      double sum = 0.0;
+      for (size_t k = 0, j = indicies.size() - 1; k < indicies.size(); j = k++)
+        sum += ((double)points[indicies[j]].x - points[indicies[k]].x) * ((double)points[indicies[k]].y + points[indicies[j]].y);
+      if ((sum > 0.0) != (r == 0)) std::reverse(indicies.begin(), indicies.end());
+
+      const GLuint first = ring.size(), count = indicies.size();
+      for (GLuint k = 0; k < count; k++) {
+        ring.push_back({
+          indicies[k], points[indicies[k]].x, points[indicies[k]].y,
+          first + (k + count - 1) % count, first + (k + 1) % count
+        });
+      }
+    }
+
+    const GLuint n = ring.size();
+    std::vector<SweepEvent> order(n);
+    for (GLuint k = 0; k < n; k++) order[k] = { ring[k].y, ring[k].x, k };
+    std::sort(order.begin(), order.end());
+
+    std::vector<PointType> types(n);
+    for (GLuint v = 0; v < n; v++) {
+      const RingPoint &p = ring[v];
+      const bool prevBelow = above(p, ring[p.prev]), nextBelow = above(p, ring[p.next]);
+      const bool convex = turn(ring[p.prev], p, ring[p.next]) > 0.0;
+      if (prevBelow && nextBelow) types[v] = convex ? PointType::Start : PointType::Split;
+      else if (!prevBelow && !nextBelow) types[v] = convex ? PointType::End : PointType::Merge;
+      else types[v] = PointType::Regular;
+    }
+
+    // Sweep, edges are named after their first point.
+    SweepStatus status(ring);
+    std::vector<SweepStatus::Edges::iterator> where(n);
+    std::vector<GLuint> helper(n, SweepStatus::NONE);
+    std::vector<std::pair<GLuint, GLuint>> diagonals;
+
+    auto insert = [&](GLuint e, GLuint v) {
+      where[e] = status.insert(e);
+      helper[e] = v;
+    };
+    auto remove = [&](GLuint e, GLuint v) {
+      if (types[helper[e]] == PointType::Merge) diagonals.push_back({ v, helper[e] });
+      status.edges.erase(where[e]);
+    };
+    auto connect_left = [&](GLuint v) {
+      const GLuint e = status.left_of();
+      if (e == SweepStatus::NONE) return false;
+      if (types[helper[e]] == PointType::Merge || types[v] == PointType::Split) diagonals.push_back({ v, helper[e] });
+      helper[e] = v;
+      return true;
+    };
+
+    for (const SweepEvent &event : order) {
+      const GLuint v = event.id;
+      const RingPoint &p = ring[v];
+      status.move_to(p);
+
+      switch (types[v]) {
+        case PointType::Start:
+          insert(v, v);
+          break;
+        case PointType::End:
+          remove(p.prev, v);
+          break;
+        case PointType::Split:
+          if (!connect_left(v)) return false;
+          insert(v, v);
+          break;
+        case PointType::Merge:
+          remove(p.prev, v);
+          if (!connect_left(v)) return false;
+          break;
+        case PointType::Regular:
+          // Interior to the right, on a left chain going down.
+          if (above(ring[p.prev], p)) {
+            remove(p.prev, v);
+            insert(v, v);
+          } else if (!connect_left(v)) {
+            return false;
+          }
+          break;
+      }
+    }
+
+    // Edges leaving each point, its ring edge first, then its diagonals.
+    std::vector<size_t> offsets(n + 1, 1);
+    offsets[n] = 0;
+    for (const auto &d : diagonals) {
+      offsets[d.first]++;
+      offsets[d.second]++;
+    }
+    size_t total = 0;
+    for (GLuint v = 0; v <= n; v++) {
+      const size_t count = offsets[v];
+      offsets[v] = total;
+      total += count;
+    }
+
+    std::vector<GLuint> targets(total), origins(total);
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (GLuint v = 0; v < n; v++) targets[fill[v]++] = ring[v].next;
+    for (const auto &d : diagonals) {
+      targets[fill[d.first]++] = d.second;
+      targets[fill[d.second]++] = d.first;
+    }
+    for (GLuint v = 0; v < n; v++)
+      for (size_t s = offsets[v]; s < offsets[v + 1]; s++) origins[s] = v;
+
+    // Walk the pieces, turning as far right as possible at each point.
+    std::vector<bool> visited(total, false);
+    std::vector<GLuint> piece;
+    std::vector<std::pair<GLuint, bool>> sorted, stack;
+    for (size_t start = 0; start < total; start++) {
+      if (visited[start]) continue;
+
+      piece.clear();
+      size_t s = start;
+      do {
+        if (visited[s] || piece.size() > n) return false;
+        visited[s] = true;
+        piece.push_back(origins[s]);
+
+        const GLuint u = origins[s], v = targets[s];
+        s = next_edge(ring, targets, offsets[v], offsets[v + 1], u, v);
+      } while (s != start);
+
+      triangulate_monotone(ring, piece, sorted, stack, triangles);
+    }
+
+    return true;
+  }
+
+
+  /*
+   ***************************************************************
+   * Self Intersection
+   ***************************************************************
+   */
+  struct Edge {
+    GLuint a, b;          // Endpoint indicies, upper then lower.
+    double ax, ay;        // Endpoints, kept along for the sweep's comparisons.
+    double bx, by;
+    double slope;         // dx / dy, 0 when horizontal.
+  };
+
+  /*
+   * Edges crossed by the sweep line, left to right. Edges meeting on it are
+   * ordered below it. Kept by value, so comparisons stay within the tree.
+   */
+  class EdgeStatus {
+    private:
+      struct Order {
+        const EdgeStatus *status;
+        bool operator()(const Edge &e, const Edge &f) const { return status->less(e, f); }
+      };
+
+      double y = 0.0;         // Sweep line.
+
+    public:
+      typedef std::set<Edge, Order> Edges;
+      Edges edges;
+
+      EdgeStatus(): edges(Order { this }) {}
+
+      double x_at(const Edge &e) const {
+        if (this->y >= e.ay) return e.ax;
+        if (this->y <= e.by) return e.bx;
+        return e.ax + (this->y - e.ay) * e.slope;
+      }
+
+      bool less(const Edge &e, const Edge &f) const {
+        const double xe = this->x_at(e), xf = this->x_at(f);
+        if (xe != xf) return xe < xf;
+
+        // Heading further left first.
+        return (e.bx - e.ax) * (f.by - f.ay) - (e.by - e.ay) * (f.bx - f.ax) > 0.0;
+      }
+
+      void move_to(double y) {
+        this->y = y;
+      }
+  };
+
+  /* Whether two edges can't intersect, sharing an endpoint or not overlapping */
+  inline bool edges_disjoint(const Edge &e, const Edge &o) {
+    return o.a == e.a || o.a == e.b || o.b == e.a || o.b == e.b ||
+      std::max(o.ax, o.bx) < std::min(e.ax, e.bx) || std::min(o.ax, o.bx) > std::max(e.ax, e.bx) ||
+      o.ay < e.by || o.by > e.ay;
+  }
+
+  /* Proper or touching intersection between segments pq & rs */
+  bool segments_intersect(const glm::vec2 &p, const glm::vec2 &q, const glm::vec2 &r, const glm::vec2 &s) {
+    auto cross = [](const glm::vec2 &o, const glm::vec2 &a, const glm::vec2 &b) {
+      return sign(((double)a.x - o.x) * ((double)b.y - o.y) - ((double)a.y - o.y) * ((double)b.x - o.x));
+    };
+    auto within = [](const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c) {
+      return b.x <= std::max(a.x, c.x) && b.x >= std::min(a.x, c.x) &&
+             b.y <= std::max(a.y, c.y) && b.y >= std::min(a.y, c.y);
+    };
+
+    const int o1 = cross(p, q, r);
+    const int o2 = cross(p, q, s);
+    const int o3 = cross(r, s, p);
+    const int o4 = cross(r, s, q);
+
+    if (o1 != o2 && o3 != o4) return true;
+    if (o1 == 0 && within(p, r, q)) return true;
+    if (o2 == 0 && within(p, s, q)) return true;
+    if (o3 == 0 && within(r, p, s)) return true;
+    if (o4 == 0 && within(r, q, s)) return true;
+    return false;
+  }
+};
+
+
+std::vector<GLuint> Triangulate::polygon(const std::vector<glm::vec2> &points, const std::vector<size_t> &holes, bool *intersects) {
+  std::vector<GLuint> triangles;
+  if (intersects) *intersects = false;
+  const size_t outerLength = holes.empty() ? points.size() : holes[0];
+  if (outerLength < 3) return triangles;
+
+  // Fast path: convex rings are a fan, reusing the input order.
+  if (holes.empty() && Triangulate::is_convex(points)) {
+    triangles.reserve((points.size() - 2) * 3);
+    for (size_t i = 1; i + 1 < points.size(); i++) {
+      triangles.push_back(0);
+      triangles.push_back(i);
+      triangles.push_back(i + 1);
+    }
+    return triangles;
+  }
+
+  // Large simple polygons are swept, ear tests degrade on long thin ears.
+  const bool crossing = Triangulate::self_intersects(points, holes);
+  if (intersects) *intersects = crossing;
+  if (points.size() > MONOTONE_THRESHOLD && !crossing) {
+    triangles.reserve((points.size() + 2 * holes.size()) * 3);
+    if (monotone_partition(points, holes, triangles)) return triangles;
+    triangles.clear();
+  }
+
+  Context ctx(triangles);
+  Node *outer = linked_list(ctx, points, 0, outerLength, true);
+  if (!outer || outer->next == outer->prev) return triangles;
+
+  if (!holes.empty()) outer = eliminate_holes(ctx, points, holes, outer);
+
+  // Hash large inputs, bounded by the outer ring.
+  if (points.size() > HASH_THRESHOLD) {
+    double minX = points[0].x, minY = points[0].y;
+    double maxX = minX, maxY = minY;
+    for (size_t i = 1; i < outerLength; i++) {
+      minX = std::min(minX, (double)points[i].x);
+      minY = std::min(minY, (double)points[i].y);
+      maxX = std::max(maxX, (double)points[i].x);
+      maxY = std::max(maxY, (double)points[i].y);
+    }
+
+    // Coordinates are scaled into 15 bits for the z-order curve.
+    const double size = std::max(maxX - minX, maxY - minY);
+    ctx.minX = minX;
+    ctx.minY = minY;
+    ctx.invSize = size != 0.0 ? 32767.0 / size : 0.0;
+  }
+
+  triangles.reserve((points.size() + 2 * holes.size()) * 3);
+  earcut_linked(ctx, outer, 0);
+  return triangles;
+}
+
+bool Triangulate::is_convex(const std::vector<glm::vec2> &points) {
+  const size_t n = points.size();
+  if (n < 3) return false;
+
+  int winding = 0;
+  for (size_t i = 0; i < n; i++) {
+    const glm::vec2 &a = points[i];
+    const glm::vec2 &b = points[(i + 1) % n];
+    const glm::vec2 &c = points[(i + 2) % n];
+
+    const int turn = sign(((double)b.x - a.x) * ((double)c.y - b.y) - ((double)b.y - a.y) * ((double)c.x - b.x));
+    if (turn == 0) continue;
+    if (winding == 0) winding = turn;
+    else if (turn != winding) return false;
+  }
+
+  // Turning the same way can still wrap around more than once (star shapes).
+  double angle = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    const glm::vec2 &a = points[i];
+    const glm::vec2 &b = points[(i + 1) % n];
+    const glm::vec2 &c = points[(i + 2) % n];
+    const double cross = ((double)b.x - a.x) * ((double)c.y - b.y) - ((double)b.y - a.y) * ((double)c.x - b.x);
+    const double dot = ((double)b.x - a.x) * ((double)c.x - b.x) + ((double)b.y - a.y) * ((double)c.y - b.y);
+    angle += std::atan2(cross, dot);
+  }
+
+  return winding != 0 && std::abs(angle) < glm::two_pi<double>() + 1e-3;
+}
+
+bool Triangulate::self_intersects(const std::vector<glm::vec2> &points, const std::vector<size_t> &holes) {
+  // Collect the edges of every ring, upper point first. Repeated points
+  // would make edges around a zero length one look like they touch.
+  std::vector<Edge> edges;
+  edges.reserve(points.size());
+
+  std::vector<GLuint> ring;
+  for (size_t r = 0; r <= holes.size(); r++) {
+    const size_t start = r == 0 ? 0 : holes[r - 1];
+    const size_t end = r < holes.size() ? holes[r] : points.size();
+
+    ring_points(points, start, end, ring);
+    for (size_t k = 0; k < ring.size(); k++) {
+      GLuint a = ring[k];
+      GLuint b = ring[k + 1 < ring.size() ? k + 1 : 0];
+      if (a == b) continue;
+      if (points[b].y > points[a].y || (points[b].y == points[a].y && points[b].x < points[a].x)) std::swap(a, b);
+
+      const double dx = (double)points[b].x - points[a].x, dy = (double)points[b].y - points[a].y;
+      edges.push_back({ a, b, points[a].x, points[a].y, points[b].x, points[b].y, dy != 0.0 ? dx / dy : 0.0 });
+    }
+  }
+  if (edges.size() < 3) return false;
+
+  // Edges enter the sweep at their upper point & leave at their lower one.
+  const GLuint count = edges.size();
+  std::vector<SweepEvent> enter(count), leave(count);
+  for (GLuint e = 0; e < count; e++) {
+    enter[e] = { edges[e].ay, edges[e].ax, e };
+    leave[e] = { edges[e].by, edges[e].bx, e };
+  }
+  std::sort(enter.begin(), enter.end());
+  std::sort(leave.begin(), leave.end());
+
+  auto crosses = [&](const Edge &e, const Edge &o) {
+    return !edges_disjoint(e, o) && segments_intersect(points[e.a], points[e.b], points[o.a], points[o.b]);
+  };
+
+  // Edges only cross after being neighbors on the sweep line at some point,
+  // so each one is tested against its neighbors as they change.
+  EdgeStatus status;
+  std::vector<EdgeStatus::Edges::iterator> where(count);
+  for (size_t in = 0, out = 0; out < count;) {
+    // Leave before entering at the same point.
+    if (in < count && enter[in] < leave[out]) {
+      const GLuint e = enter[in++].id;
+      status.move_to(edges[e].ay);
+
+      const auto inserted = status.edges.insert(edges[e]);
+      if (!inserted.second) return true;      // Overlapping, from the same point.
+      where[e] = inserted.first;
+
+      if (where[e] != status.edges.begin() && crosses(edges[e], *std::prev(where[e]))) return true;
+      const auto next = std::next(where[e]);
+      if (next != status.edges.end() && crosses(edges[e], *next)) return true;
+    } else {
+      const GLuint e = leave[out++].id;
+      const auto next = status.edges.erase(where[e]);
+      if (next != status.edges.begin() && next != status.edges.end() && crosses(*std::prev(next), *next)) return true;
+    }
+  }
+
+  return false;
+}
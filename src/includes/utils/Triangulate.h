@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * Polygon triangulation.
+ *  - Large simple polygons are split into y-monotone pieces by a sweep
+ *    line, each triangulated in linear time. O(n log n) whatever the shape.
+ *  - Smaller or self-intersecting ones are ear clipped over a linked ring,
+ *    with z-order hashing on large inputs so ear tests only visit nearby
+ *    points. Holes are bridged into the outer ring before clipping.
+ *  - Convex rings without holes take a linear fan fast path.
+ *
+ * Produces n - 2 + 2h triangles, indexing into the given points.
+ */
+namespace Triangulate {
+  /**
+   * Triangulates a polygon, optionally with holes.
+   *
+   * @param points Outer ring followed by each hole's ring, in any winding.
+   * @param holes Index in points at which each hole's ring starts.
+   * @param intersects Set to whether the polygon intersects itself, see self_intersects.
+   *
+   * @returns Triangle indicies into points, 3 per triangle.
+   */
+  std::vector<GLuint> polygon(const std::vector<glm::vec2> &points, const std::vector<size_t> &holes = {}, bool *intersects = nullptr);
+
+  /**
+   * Returns whether a single ring is convex. Collinear points are allowed.
+   *
+   * @param points Ring of points, in any winding.
+   */
+  bool is_convex(const std::vector<glm::vec2> &points);
+
+  /**
+   * Returns whether any two non-adjacent edges of the polygon intersect,
+   * across the outer ring & holes. Repeated points are skipped. Edges are
+   * only tested against their neighbors along a sweep line, O(n log n).
+   *
+   * @param points Outer ring followed by each hole's ring.
+   * @param holes Index in points at which each hole's ring starts.
+   */
+  bool self_intersects(const std::vector<glm::vec2> &points, const std::vector<size_t> &holes = {});
+};
@@ -1,12 +1,21 @@
 // Engine Libraries
 #include "SimpleRender.h"
+#include "AssetPack.h"
+#include "ShaderCache.h"
 #include "Shape.h"
 #include "Rectangle.h"
 #include "Circle.h"
+#include "SDFCircle.h"
 #include "Polygon.h"
+#include "Geometry.h"
+#include "InstancedMesh.h"
+#include "GLState.h"
 
 // Helper Libraries
 #include <spdlog/spdlog.h>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
 
 // Graphics libraries.
 #include <glm/glm.hpp>
@@ -20,7 +29,6 @@
 
 class App : public SimpleRender {
   private:
-    bool shaderUpdateActive = false;
     bool trackMouseMove = false;
     glm::vec2 prevMousePos = glm::vec2();
 
@@ -33,6 +41,8 @@ class App : public SimpleRender {
     double near    = 1.0f;
 
     std::vector<Shape*> entities = {};
+    InstancedMesh *instancedCircles = nullptr;
+    TextureAtlas atlas;
 
 
     void onKey(int key, int scancode, int action, int mods) {
@@ -102,6 +112,23 @@ class App : public SimpleRender {
         ImGui::TextColored(TEXT_PURPLE_COLOR, "FPS: %.2f", this->getFPS());
       }
 
+      // Frame times.
+      if (ImGui::CollapsingHeader("Frame Times", ImGuiTreeNodeFlags_DefaultOpen)) {
+        this->frameStats.drawImGui();
+      }
+
+      // Batch statistics.
+      {
+        const BatchStats &stats = this->batchRenderer.getStats();
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "Batches: %zu (%zu draw calls)", stats.batches, stats.drawCalls);
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "Shapes: %zu", stats.shapes);
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "Verticies: %zu | Indicies: %zu", stats.verticies, stats.indicies);
+
+        const GLStateStats &glStats = GLState::getStats();
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "GL Binds: %zu issued | %zu skipped", glStats.issued, glStats.skipped);
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "Uploaded: %.1f KB", glStats.uploaded / 1024.0);
+      }
+
       // Window dimensions.
       {
         int width, height;
@@ -123,6 +150,47 @@ class App : public SimpleRender {
         ImGui::EndGroup();
       }
 
+      // Frame capture.
+      {
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "Capture: ");
+
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Screenshot"))
+          this->frameCapture.screenshot("screenshot.png");
+        ImGui::SameLine();
+        if (ImGui::SmallButton(this->frameCapture.isRecording() ? "Stop" : "Record")) {
+          if (this->frameCapture.isRecording()) this->frameCapture.stopRecording();
+          else this->frameCapture.startRecording("recording.y4m", 60);
+        }
+
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "In flight: %zu | Dropped: %zu | Written: %zu",
+          this->frameCapture.getInFlight(), this->frameCapture.getDropped(), this->frameCapture.getCaptured());
+      }
+
+      // Texture cache.
+      {
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "Textures: %zu loaded | %zu pending",
+          TextureCache::get().getLoaded(), TextureCache::get().getPending());
+      }
+
+      // Shader cache.
+      {
+        ImGui::TextColored(TEXT_PURPLE_COLOR, "Shaders: %zu compiled | %zu from binaries | %zu linking",
+          ShaderCache::get().getCompiled(), ShaderCache::get().getCached(), ShaderCache::get().getPending());
+      }
+
+      // Profiler.
+      if (ImGui::CollapsingHeader("Profiler")) {
+        bool enabled = Profiler::get().isEnabled();
+        if (ImGui::Checkbox("Record", &enabled))
+          Profiler::get().setEnabled(enabled);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Export Trace"))
+          Profiler::get().writeChromeTrace("trace.json");
+
+        Profiler::get().drawImGui();
+      }
+
       // Rasterization modes.
       {
         ImGui::TextColored(TEXT_PURPLE_COLOR, "Rasterization: ");
@@ -154,48 +222,58 @@ class App : public SimpleRender {
     ~App() {
       for (Shape *s : this->entities)
         if (s) delete s;
+      if (this->instancedCircles) delete this->instancedCircles;
     }
 
-    void enableLiveShaderUpdate() { shaderUpdateActive = true; }
-    void disableLiveShaderUpdate() { shaderUpdateActive = false; }
+    void enableLiveShaderUpdate() { ShaderCache::get().setLiveUpdate(true); }
+    void disableLiveShaderUpdate() { ShaderCache::get().setLiveUpdate(false); }
 
     /* Configure/Load Data that will be used in Application */
     void Preload() {
-      // Setting up entities.
+      // Shaders link in parallel from here on, checked before the first frame.
+      ShaderCache::get().setProgressCallback([](size_t linked, size_t total) {
+        spdlog::info("Shaders: {}/{} linked", linked, total);
+      });
+
+      // Shape images share an atlas page, so they can batch together.
+      const size_t checkerboard = this->atlas.add("./textures/615-checkerboard.png");
+      const size_t wall = this->atlas.add("./textures/texture.png");
+      this->atlas.build();
+
+      // Setting up entities. Shapes using the same sources share a program.
       {
         // Custom shader.
-        std::shared_ptr<Shader> shader = std::make_shared<Shader>();
-        shader->compile("./shaders/shader.vert", "./shaders/shader2.frag");
+        std::shared_ptr<Shader> shader = ShaderCache::get().load("./shaders/shader.vert", "./shaders/shader2.frag");
 
         Shape *e = reinterpret_cast<Shape*>(new Rectangle{
           (WIDTH / 2.f) + 100.f, HEIGHT / 3.f,
           400.f, 350.f,
           shader,
-          "./textures/615-checkerboard.png"
+          nullptr
         });
 
         e->set_origin(e->get_center_vec());
+        e->set_texture_region(this->atlas.get(checkerboard));
         this->entities.push_back(e);
       }
 
       {
-        std::shared_ptr<Shader> shader = std::make_shared<Shader>();
-        shader->compile("./shaders/shader.vert", "./shaders/shader.frag");
+        std::shared_ptr<Shader> shader = ShaderCache::get().load("./shaders/shader.vert", "./shaders/shader.frag");
 
         Shape *e = reinterpret_cast<Shape*>(new Rectangle{
           (WIDTH / 2.f) + - 450.f, HEIGHT / 3.f,
           400.f, 350.f,
           shader,
-          "./textures/texture.png"
+          nullptr
         });
 
         e->set_origin(e->get_center_vec());
+        e->set_texture_region(this->atlas.get(wall));
         this->entities.push_back(e);
       }
 
       {
-        std::shared_ptr<Shader> shader = std::make_shared<Shader>();
-        shader->compile("./shaders/shader.vert", "./shaders/shader2.frag");
+        std::shared_ptr<Shader> shader = ShaderCache::get().load("./shaders/shader.vert", "./shaders/shader2.frag");
 
         double x = (WIDTH / 2.f);
         double y = (HEIGHT / 2.f) - 200.f;
@@ -209,31 +287,63 @@ class App : public SimpleRender {
             {x + 200.0,   y - 100.0}
           },
           shader,
-          "./textures/615-checkerboard.png",
+          nullptr,
         });
 
         // e->set_origin(e->get_center_vec());
+        e->set_texture_region(this->atlas.get(checkerboard));
         this->entities.push_back(e);
       }
 
       {
-        std::shared_ptr<Shader> shader = std::make_shared<Shader>();
-        shader->compile("./shaders/shader.vert", "./shaders/shader2.frag");
+        std::shared_ptr<Shader> shader = ShaderCache::get().load("./shaders/shader.vert", "./shaders/shader2.frag");
 
         Shape *e = reinterpret_cast<Shape*>(new Circle{
           (WIDTH / 2.f), (HEIGHT / 2.f) + 300.f,
           100.f,    // radius
           shader,
-          "./textures/615-checkerboard.png",
-          // nullptr,  // no texture
+          nullptr,  // sampled from the atlas
           2000       // quality = data points
         });
 
         // useSolidColor(shader.get(), glm::vec4(255.f, 0.f, 0.f, 255.f));
         e->set_origin(e->get_center_vec());
+        e->set_texture_region(this->atlas.get(checkerboard));
         this->entities.push_back(e);
       }
 
+      {
+        std::shared_ptr<Shader> shader = ShaderCache::get().load("./shaders/shader.vert", "./shaders/sdf_circle.frag");
+
+        // Same circle as above, as a single anti-aliased quad.
+        Shape *e = reinterpret_cast<Shape*>(new SDFCircle{
+          (WIDTH / 2.f) + 250.f, (HEIGHT / 2.f) + 300.f,
+          100.f,    // radius
+          shader,
+          "./textures/615-checkerboard.png"
+        });
+
+        e->set_origin(e->get_center_vec());
+        this->entities.push_back(e);
+      }
+
+      // Instanced circles, sharing a single mesh.
+      {
+        std::shared_ptr<Shader> shader = ShaderCache::get().load("./shaders/instanced.vert", "./shaders/instanced.frag");
+
+        this->instancedCircles = new InstancedMesh(Geometry::circle(0.0, 0.0, 10.0, 64), shader, nullptr);
+        for (size_t i = 0; i < 64; i++) {
+          const float t = i / 64.f;
+          this->instancedCircles->add(Instance::make(
+            glm::vec2{ 50.f + i * 24.f, 40.f },
+            0.f,
+            glm::vec2{ 1.f },
+            glm::vec2{ 0.f },
+            glm::vec4{ 255.f * t, 128.f, 255.f * (1.f - t), 255.f }
+          ));
+        }
+      }
+
       spdlog::info("Loaded entities -> {}", this->entities.size());
 
       // Display some Internal Info
@@ -246,111 +356,127 @@ class App : public SimpleRender {
       spdlog::info("Delta Time[{:.2f}]", dt);
     }
 
-    void updateUniforms(Shader *shader) {
+    glm::mat4 getViewTransform() override {
       // Transform Based on Input
       glm::mat4 trans(1.0f);
       trans = glm::ortho(-transZ, transZ, -transZ, transZ, -near, near);
       trans = glm::translate(trans, glm::vec3(transX, transY, 0.0f));
-
-      /* Get Uniform Locations */
-      GLint utransfrom  = glGetUniformLocation(shader->ID, "transform");
-      GLint u_time      = glGetUniformLocation(shader->ID, "u_time");
-      GLint u_mouse     = glGetUniformLocation(shader->ID, "u_mouse");
-      GLint u_res       = glGetUniformLocation(shader->ID, "u_res");
-
-      // Pass in the canvas transform.
-      glUniformMatrix4fv(utransfrom, 1, GL_FALSE, glm::value_ptr(trans));
-
-      // Update Uniform Data
-      glUniform1f(u_time, glfwGetTime());
-
-      // Set Resolution Vector
-      int width, height;
-      glfwGetWindowSize(this->getWindow(), &width, &height);
-      glm::vec2 v_res(width, height);
-      glUniform2fv(u_res, 1, glm::value_ptr(v_res));  // A Single vec2 Float
-
-      // Mouse position.
-      glUniform2fv(u_mouse, 1, glm::value_ptr(this->getMousePos()));
+      return trans;
     }
 
     void useSolidColor(Shader *shader, glm::vec4 vertexColor) {
-      // Get uniform location for using a vertex color + flag to use it.
-      GLint uniformUseTexture   = glGetUniformLocation(shader->ID, "useTexture");
-      GLint uniformSolidColor   = glGetUniformLocation(shader->ID, "solidColor");
-
       // Toggle using the vertex color + set the color.
-      glUniform1ui(uniformUseTexture, false);
-      glUniform4f(uniformSolidColor, vertexColor.r, vertexColor.g, vertexColor.b, vertexColor.a);
+      shader->setUniform("useTexture", false);
+      shader->setUniform("solidColor", vertexColor);
+    }
+
+    /* Per-frame uniforms are shared through the FrameData block */
+    void prepareBatch(Shader *shader, Texture *texture) override {
+      if (!texture) useSolidColor(shader, glm::vec4(255.f, 0.f, 0.f, 255.f));
     }
 
     /* Main Draw location of Application */
     void Draw() {
-      // Output FPS to Window Title
-      sprintf(titleBuffer, "%s [%.2f FPS]", title, getFPS());
-      glfwSetWindowTitle(window, titleBuffer);
-
-
       // Translate them entities.
-      double gl_time = glfwGetTime();
+      double gl_time = getTime();
       glm::vec2 trans{sin(gl_time), 0.f};
 
-      // Draw entities.
-      for (Shape *entity : this->entities) {
-        const BufferData &bd = entity->buffer;
+      // World units are pixels at no zoom, the ortho view scales them by 1/transZ.
+      const float pixels_per_unit = 1.f / transZ;
 
+      // Update & batch entities.
+      for (Shape *entity : this->entities) {
         entity->translate(trans);
         entity->rotate(0.01f);
         entity->scale(glm::vec2{ 1.f + (float)sin(gl_time) * 0.0015f });
+        entity->update_lod(pixels_per_unit);
         entity->update();
 
-        // Activate the bound shader program.
-        bd.shader->use();
-
-        // Pass in the uniform values into each of the vertex shader programs.
-        updateUniforms(bd.shader.get());
-
-        // Enable aPos Attribute
-        glEnableVertexAttribArray(0);
-
-        // Bind Vertex Array Object
-        glBindVertexArray(bd.VAO);
-
-        // Bind Index Buffer
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd.indiciesBuffer);
-
-        // Bind the Texture
-        if (bd.texture) bd.texture->bind(0);
-        else useSolidColor(bd.shader.get(), glm::vec4(255.f, 0.f, 0.f, 255.f));
-
-        // Draw
-        glDrawElements(GL_TRIANGLES, bd.indiciesElts, GL_UNSIGNED_INT, nullptr);
-
-        // Unbind the Texture
-        if (bd.texture) bd.texture->unbind();
-
-        // Disable aPos Attribute
-        glDisableVertexAttribArray(0);
-
-        // Deactivate shader program.
-        glUseProgram(0);
+        // Sorted & batched once Draw returns.
+        this->submit(entity);
+      }
 
-        // Live update each shader on mod.
-        if (this->shaderUpdateActive) bd.shader->liveGLSLUpdateShaders();
+      // Draw instanced entities.
+      {
+        this->instancedCircles->mesh.shader->use();
+        this->instancedCircles->draw();
       }
     }
 };
 
 
-int main() {
+/**
+ * Writes an RGBA frame, bottom row first, as a binary PPM image.
+ *
+ * @param path Output file path.
+ * @param rgba Pixels read back from the renderer.
+ * @param width Width of the frame.
+ * @param height Height of the frame.
+ */
+static bool writePPM(const char *path, const std::vector<GLubyte> &rgba, int width, int height) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) return false;
+
+  file << "P6\n" << width << " " << height << "\n255\n";
+  for (int y = height - 1; y >= 0; y--) {
+    for (int x = 0; x < width; x++) {
+      const GLubyte *pixel = &rgba[((size_t)y * width + x) * 4];
+      file.write((const char*)pixel, 3);
+    }
+  }
+  return (bool)file;
+}
+
+int main(int argc, char **argv) {
   spdlog::info("Welcome to spdlog version {}.{}.{}!", SPDLOG_VER_MAJOR, SPDLOG_VER_MINOR, SPDLOG_VER_PATCH);
 
   App app(WIDTH, HEIGHT, "2D Simple Render");
-  app.enableLiveShaderUpdate();
+
+  // Usage: app [--pack <assets.pack>] [--trace <trace.json>] [--headless <frames> [output.ppm]]
+  bool headless = false;
+  size_t frames = 1;
+  const char *output = nullptr;
+  const char *trace = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+      // Assets missing from the pack still load from loose files.
+      AssetPack::get().open(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      // Profiled frames are written on exit.
+      trace = argv[++i];
+      Profiler::get().setEnabled(true);
+    }
+    else if (strcmp(argv[i], "--headless") == 0) {
+      headless = true;
+      if (i + 1 < argc && isdigit(argv[i + 1][0])) frames = strtoul(argv[++i], nullptr, 10);
+      if (i + 1 < argc && argv[i + 1][0] != '-') output = argv[++i];
+    }
+  }
+
+  if (headless) {
+    app.setHeadless(frames);
+  } else {
+    app.enableLiveShaderUpdate();
+  }
 
   int status = app.run();
   if (status != 0)
     std::cerr << "Status = " << status << std::endl;
 
+  if (trace) Profiler::get().writeChromeTrace(trace);
+
+  // Read back the last frame.
+  if (headless && status == 0) {
+    spdlog::info("Rendered {} frames offscreen", app.getFrameCount());
+
+    if (output) {
+      std::vector<GLubyte> rgba;
+      app.readPixels(rgba);
+      if (!writePPM(output, rgba, WIDTH, HEIGHT))
+        spdlog::error("Failed to write frame to '{}'", output);
+    }
+  }
+
   return 0;
 }
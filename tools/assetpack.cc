@@ -0,0 +1,56 @@
+/*
+ * Offline asset packer.
+ *  Packs shaders, textures & any other files into a single archive,
+ *  memory mapped at runtime by AssetPack.
+ *
+ * Usage: assetpack <output.pack> <files or directories...>
+ *  - Directories are packed recursively
+ *  - Assets are stored under the paths given, e.g. "shaders/shader.vert"
+ */
+#include "AssetPack.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    spdlog::error("Usage: {} <output.pack> <files or directories...>", argv[0]);
+    return 1;
+  }
+
+  // Expand directories into their files.
+  std::vector<std::string> paths;
+  for (int i = 2; i < argc; i++) {
+    const std::filesystem::path input(argv[i]);
+    if (std::filesystem::is_directory(input)) {
+      for (const auto &entry : std::filesystem::recursive_directory_iterator(input))
+        if (entry.is_regular_file()) paths.push_back(entry.path().generic_string());
+    }
+    else {
+      paths.push_back(input.generic_string());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+  if (!AssetPack::write(argv[1], paths)) return 1;
+
+  // Read it back, so a broken pack never ships.
+  AssetPack pack;
+  if (!pack.open(argv[1])) return 1;
+
+  for (const std::string &path : paths) {
+    Asset asset;
+    if (!pack.find(path, asset)) {
+      spdlog::error("'{}' is missing from the pack", path);
+      return 1;
+    }
+  }
+
+  spdlog::info("Packed {} assets into '{}'", pack.size(), argv[1]);
+  return 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * Offline texture converter.
+ *  Turns PNGs (or anything stb_image reads) into block compressed
+ *  DDS/KTX2 textures with a full mip chain, loaded by Texture without
+ *  decoding or generating mipmaps.
+ *
+ * Usage: texconv [--bc1 | --bc3] [--no-mips] <input.png> <output.dds|output.ktx2>
+ *  - Opaque images default to BC1 (4 bits/texel), others to BC3 (8 bits/texel)
+ *  - --bc1 on an image with alpha keeps 1-bit (punch-through) alpha
+ */
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image/stb_image.h>
+#include "utils/TextureFile.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+/* RGBA image, top row first */
+struct Image {
+  int width, height;
+  std::vector<uint8_t> pixels;
+};
+
+
+/*
+ ***************************************************************
+ * Mip Chain
+ *	- Each level is a 2x2 box filter of the previous one, odd
+ *	edges reuse the last row/column
+ ***************************************************************
+ */
+Image downsample(const Image &src) {
+  Image dst { std::max(src.width / 2, 1), std::max(src.height / 2, 1), {} };
+  dst.pixels.resize((size_t)dst.width * dst.height * 4);
+
+  for (int y = 0; y < dst.height; y++) {
+    const int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+    for (int x = 0; x < dst.width; x++) {
+      const int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+      for (int c = 0; c < 4; c++) {
+        const int sum =
+          src.pixels[((size_t)y0 * src.width + x0) * 4 + c] + src.pixels[((size_t)y0 * src.width + x1) * 4 + c] +
+          src.pixels[((size_t)y1 * src.width + x0) * 4 + c] + src.pixels[((size_t)y1 * src.width + x1) * 4 + c];
+        dst.pixels[((size_t)y * dst.width + x) * 4 + c] = (sum + 2) / 4;
+      }
+    }
+  }
+  return dst;
+}
+
+
+/*
+ ***************************************************************
+ * BC1 Color Blocks
+ *	- Endpoints span the block's principal axis, inset to cut
+ *	the error of the outliers
+ *	- Each texel takes the closest of the palette colors
+ ***************************************************************
+ */
+uint16_t pack565(const float c[3]) {
+  const int r = std::clamp((int)std::lround(c[0] * 31.f / 255.f), 0, 31);
+  const int g = std::clamp((int)std::lround(c[1] * 63.f / 255.f), 0, 63);
+  const int b = std::clamp((int)std::lround(c[2] * 31.f / 255.f), 0, 31);
+  return (r << 11) | (g << 5) | b;
+}
+
+void unpack565(uint16_t v, int c[3]) {
+  const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+  c[0] = (r << 3) | (r >> 2);
+  c[1] = (g << 2) | (g >> 4);
+  c[2] = (b << 3) | (b >> 2);
+}
+
+/**
+ * Encodes the colors of a 4x4 block.
+ *  @param texels 16 RGBA texels
+ *  @param punchThrough Use 3 colors + transparent, for texels with alpha < 128
+ *  @param out 8 bytes of BC1 block
+ */
+void encode_color_block(const uint8_t texels[64], bool punchThrough, uint8_t out[8]) {
+  bool transparent[16] = {};
+  bool anyTransparent = false;
+  if (punchThrough) {
+    for (int i = 0; i < 16; i++) {
+      transparent[i] = texels[i * 4 + 3] < 128;
+      anyTransparent |= transparent[i];
+    }
+  }
+
+  // Mean & covariance of the opaque texels.
+  float mean[3] = {};
+  int count = 0;
+  for (int i = 0; i < 16; i++) {
+    if (transparent[i]) continue;
+    for (int c = 0; c < 3; c++) mean[c] += texels[i * 4 + c];
+    count++;
+  }
+
+  uint16_t c0 = 0, c1 = 0;
+  if (count > 0) {
+    for (int c = 0; c < 3; c++) mean[c] /= count;
+
+    float cov[6] = {};
+    for (int i = 0; i < 16; i++) {
+      if (transparent[i]) continue;
+      const float d[3] = { texels[i * 4] - mean[0], texels[i * 4 + 1] - mean[1], texels[i * 4 + 2] - mean[2] };
+      cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+      cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+
+    // Principal axis through power iteration.
+    float axis[3] = { 1.f, 1.f, 1.f };
+    for (int iter = 0; iter < 8; iter++) {
+      const float v[3] = {
+        cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+        cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+        cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2],
+      };
+      const float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+      if (len < 1e-6f) break;
+      for (int c = 0; c < 3; c++) axis[c] = v[c] / len;
+    }
+
+    float tMin = 1e9f, tMax = -1e9f;
+    for (int i = 0; i < 16; i++) {
+      if (transparent[i]) continue;
+      float t = 0.f;
+      for (int c = 0; c < 3; c++) t += (texels[i * 4 + c] - mean[c]) * axis[c];
+      tMin = std::min(tMin, t);
+      tMax = std::max(tMax, t);
+    }
+
+    const float inset = (tMax - tMin) / 16.f;
+    float lo[3], hi[3];
+    for (int c = 0; c < 3; c++) {
+      lo[c] = mean[c] + axis[c] * (tMin + inset);
+      hi[c] = mean[c] + axis[c] * (tMax - inset);
+    }
+    c0 = pack565(hi);
+    c1 = pack565(lo);
+  }
+
+  // 4 color mode needs c0 > c1, 3 color + transparent needs c0 <= c1.
+  if (anyTransparent ? c0 > c1 : c0 < c1) std::swap(c0, c1);
+  const bool fourColors = c0 > c1;
+
+  int palette[4][3];
+  unpack565(c0, palette[0]);
+  unpack565(c1, palette[1]);
+  for (int c = 0; c < 3; c++) {
+    if (fourColors) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    else {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+      palette[3][c] = 0;
+    }
+  }
+
+  uint32_t indices = 0;
+  for (int i = 0; i < 16; i++) {
+    uint32_t best = 3;
+    if (!transparent[i]) {
+      int bestError = INT32_MAX;
+      const int choices = fourColors ? 4 : 3;
+      for (int p = 0; p < choices; p++) {
+        int error = 0;
+        for (int c = 0; c < 3; c++) {
+          const int d = texels[i * 4 + c] - palette[p][c];
+          error += d * d;
+        }
+        if (error < bestError) {
+          bestError = error;
+          best = p;
+        }
+      }
+    }
+    indices |= best << (i * 2);
+  }
+
+  memcpy(out, &c0, 2);
+  memcpy(out + 2, &c1, 2);
+  memcpy(out + 4, &indices, 4);
+}
+
+
+/*
+ ***************************************************************
+ * BC3 Alpha Blocks
+ *	- 8 interpolated alphas between the block's min & max
+ ***************************************************************
+ */
+void encode_alpha_block(const uint8_t texels[64], uint8_t out[8]) {
+  int a0 = 0, a1 = 255;
+  for (int i = 0; i < 16; i++) {
+    a0 = std::max<int>(a0, texels[i * 4 + 3]);
+    a1 = std::min<int>(a1, texels[i * 4 + 3]);
+  }
+
+  // Palette index order: a0, a1, then 6 steps from a0 towards a1.
+  int palette[8] = { a0, a1 };
+  for (int i = 1; i <= 6; i++)
+    palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+
+  uint64_t indices = 0;
+  if (a0 > a1) {
+    for (int i = 0; i < 16; i++) {
+      uint64_t best = 0;
+      int bestError = INT32_MAX;
+      for (int p = 0; p < 8; p++) {
+        const int error = std::abs(texels[i * 4 + 3] - palette[p]);
+        if (error < bestError) {
+          bestError = error;
+          best = p;
+        }
+      }
+      indices |= best << (i * 3);
+    }
+  }
+
+  out[0] = a0;
+  out[1] = a1;
+  for (int i = 0; i < 6; i++) out[2 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+
+/* Compresses a level, block rows top first like the texels */
+std::vector<uint8_t> compress(const Image &image, GLenum format) {
+  const bool bc3 = format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+  const bool punchThrough = format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+  const int blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+
+  std::vector<uint8_t> blocks(TextureFile::level_size(format, image.width, image.height));
+  uint8_t *out = blocks.data();
+
+  for (int by = 0; by < blocksY; by++) {
+    for (int bx = 0; bx < blocksX; bx++) {
+      // Gather the block, clamping on partial edge blocks.
+      uint8_t texels[64];
+      for (int y = 0; y < 4; y++) {
+        const int sy = std::min(by * 4 + y, image.height - 1);
+        for (int x = 0; x < 4; x++) {
+          const int sx = std::min(bx * 4 + x, image.width - 1);
+          memcpy(&texels[(y * 4 + x) * 4], &image.pixels[((size_t)sy * image.width + sx) * 4], 4);
+        }
+      }
+
+      if (bc3) {
+        encode_alpha_block(texels, out);
+        out += 8;
+      }
+      encode_color_block(texels, punchThrough, out);
+      out += 8;
+    }
+  }
+  return blocks;
+}
+
+
+int main(int argc, char **argv) {
+  std::string input, output;
+  std::string forced;
+  bool mips = true;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--bc1" || arg == "--bc3") forced = arg;
+    else if (arg == "--no-mips") mips = false;
+    else if (input.empty()) input = arg;
+    else output = arg;
+  }
+
+  if (input.empty() || output.empty()) {
+    spdlog::error("Usage: {} [--bc1 | --bc3] [--no-mips] <input.png> <output.dds|output.ktx2>", argv[0]);
+    return 1;
+  }
+
+  // Top row first, as DDS & KTX2 store them. Shapes flip v when sampling them.
+  stbi_set_flip_vertically_on_load(false);
+
+  Image image;
+  int channels;
+  unsigned char *data = stbi_load(input.c_str(), &image.width, &image.height, &channels, 4);
+  if (!data) {
+    spdlog::error("Failed to load '{}': {}", input, stbi_failure_reason());
+    return 1;
+  }
+  image.pixels.assign(data, data + (size_t)image.width * image.height * 4);
+  stbi_image_free(data);
+
+  bool opaque = true;
+  for (size_t i = 3; i < image.pixels.size() && opaque; i += 4)
+    opaque = image.pixels[i] == 255;
+
+  CompressedImage compressed;
+  compressed.width = image.width;
+  compressed.height = image.height;
+  if (forced == "--bc1") compressed.format = opaque ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+  else if (forced == "--bc3") compressed.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+  else compressed.format = opaque ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+  // Compress each level into a single store, then point the levels into it.
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::vector<uint8_t>> levels;
+  for (Image level = image; ; level = downsample(level)) {
+    levels.push_back(compress(level, compressed.format));
+    compressed.levels.push_back({ level.width, level.height, nullptr, levels.back().size() });
+    if (!mips || (level.width == 1 && level.height == 1)) break;
+  }
+
+  for (const std::vector<uint8_t> &level : levels)
+    compressed.storage.insert(compressed.storage.end(), level.begin(), level.end());
+
+  size_t offset = 0;
+  for (CompressedLevel &level : compressed.levels) {
+    level.data = compressed.storage.data() + offset;
+    offset += level.size;
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (!TextureFile::save(output, compressed)) return 1;
+
+  const size_t rgbaSize = (size_t)image.width * image.height * 4;
+  spdlog::info("{} -> {}: {}x{}, {} levels, {} bytes ({:.1f}x smaller than RGBA8 base), {:.2f}s",
+    input, output, image.width, image.height, compressed.levels.size(),
+    compressed.storage.size(), (double)rgbaSize / compressed.storage.size(), seconds);
+  return 0;
+}